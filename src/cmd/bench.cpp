@@ -0,0 +1,375 @@
+#include "pch.h"
+#include "../core/conf.h"
+#include "../core/ini.h"
+#include "../core/op.h"
+#include "../tasks/task_manager.h"
+#include "../utility/io.h"
+#include "commands.h"
+#include <random>
+
+namespace mob {
+
+    bench_command::bench_command() : command(requires_options) {}
+
+    command::meta_t bench_command::meta() const
+    {
+        return {"bench", "runs microbenchmarks on mob itself"};
+    }
+
+    clipp::group bench_command::do_group()
+    {
+        return clipp::group(
+            clipp::command("bench").set(picked_),
+
+            (clipp::option("-h", "--help") >> help_) % ("shows this message"),
+
+            (clipp::option("-n", "--iterations") &
+             clipp::value("COUNT").call([&](const char* s) {
+                 iterations_ = std::max(1, std::stoi(s));
+             })) %
+                "number of iterations, defaults to 1000 for conf and tasks, 10 for "
+                "ini and 10000 for fuzz",
+
+            (clipp::option("--seed") &
+             clipp::value("SEED").call([&](const char* s) {
+                 seed_ = static_cast<unsigned int>(std::stoul(s));
+             })) %
+                "seed for fuzz, defaults to 0",
+
+            (clipp::command("conf").set(what_, benchmark::conf) %
+                 "looks up every task option for every task" |
+             clipp::command("ini").set(what_, benchmark::ini) %
+                 "parses and processes overrides for every task option" |
+             clipp::command("tasks").set(what_, benchmark::tasks) %
+                 "looks up tasks by name, glob and alias" |
+             clipp::command("fuzz").set(what_, benchmark::fuzz) %
+                 "parses mutated versions of the inis"));
+    }
+
+    std::string bench_command::do_doc()
+    {
+        return "Times some of the things mob does on every invocation, to check "
+               "for\nregressions.";
+    }
+
+    int bench_command::do_run()
+    {
+        switch (what_) {
+        case benchmark::conf:
+            bench_conf();
+            break;
+
+        case benchmark::ini:
+            bench_ini();
+            break;
+
+        case benchmark::tasks:
+            bench_tasks();
+            break;
+
+        case benchmark::fuzz:
+            return (fuzz_ini() ? 0 : 1);
+        }
+
+        return 0;
+    }
+
+    std::size_t bench_command::iterations(std::size_t def) const
+    {
+        if (iterations_)
+            return static_cast<std::size_t>(*iterations_);
+
+        return def;
+    }
+
+    void bench_command::bench_conf()
+    {
+        const auto n     = iterations(1000);
+        const auto tasks = task_manager::instance().all().size();
+
+        // warm up, the first lookups allocate
+        bench_task_options(1, false);
+        bench_task_options(1, true);
+
+        const auto maps   = bench_task_options(n, false);
+        const auto frozen = bench_task_options(n, true);
+
+        auto per_task = [&](std::chrono::nanoseconds d) {
+            return static_cast<double>(d.count()) / static_cast<double>(n * tasks);
+        };
+
+        u8cout << std::format("{} tasks, {} iterations, all task options per "
+                              "task\n",
+                              tasks, n)
+               << std::format("  maps:   {:>10.0f} ns per task\n", per_task(maps))
+               << std::format("  frozen: {:>10.0f} ns per task\n", per_task(frozen));
+    }
+
+    void bench_command::bench_ini()
+    {
+        // every task gets this many sections, which is way more than any real
+        // ini, but it's the task sections and overrides that are slow
+        const std::size_t copies = 4;
+
+        const auto n        = iterations(10);
+        const auto sections = copies * task_manager::instance().all().size();
+        const auto o        = make_bench_options(copies);
+
+        const auto ini = make_temp_file();
+        guard g([&] {
+            op::delete_file(gcx(), ini, op::optional);
+        });
+
+        op::write_text_file(gcx(), encodings::utf8, ini, o.ini);
+
+        // warm up
+        parse_ini(ini);
+
+        const auto start = hr_clock::now();
+
+        for (std::size_t i = 0; i < n; ++i)
+            parse_ini(ini);
+
+        const auto parse = hr_clock::now() - start;
+
+        const auto process = bench_process_ini(ini, n);
+        const auto cmd     = bench_cmd_options(o.cmd, n);
+
+        auto per_option = [&](std::chrono::nanoseconds d) {
+            return static_cast<double>(d.count()) /
+                   static_cast<double>(n * o.cmd.size());
+        };
+
+        u8cout << std::format("{} task sections, {} options, {} iterations\n",
+                              sections, o.cmd.size(), n)
+               << std::format("  parse:              {:>10.0f} ns per option\n",
+                              per_option(parse))
+               << std::format("  parse and process:  {:>10.0f} ns per option\n",
+                              per_option(process))
+               << std::format("  command line:       {:>10.0f} ns per option\n",
+                              per_option(cmd));
+    }
+
+    void bench_command::bench_tasks()
+    {
+        const auto n = iterations(1000);
+        auto& tm     = task_manager::instance();
+
+        // every name of every task, and the patterns and names of the aliases,
+        // which is what ends up in find() from the inis and the command line
+        std::vector<std::string> names, globs, aliases;
+
+        for (auto* t : tm.all()) {
+            for (auto&& name : t->names())
+                names.push_back(name);
+        }
+
+        for (auto&& [k, patterns] : tm.aliases()) {
+            aliases.push_back(k);
+
+            for (auto&& p : patterns) {
+                if (p.find('*') == std::string::npos)
+                    names.push_back(p);
+                else
+                    globs.push_back(p);
+            }
+        }
+
+        // there's always at least one glob, in case the inis don't have any
+        globs.push_back("*");
+
+        // the count is printed so the lookups can't be optimized out
+        std::size_t found = 0;
+
+        auto time_find = [&](const std::vector<std::string>& v) {
+            const auto start = hr_clock::now();
+
+            for (std::size_t i = 0; i < n; ++i) {
+                for (auto&& p : v)
+                    found += tm.find(p).size();
+            }
+
+            return hr_clock::now() - start;
+        };
+
+        // what find() did before the index, calling name_matches() on every task
+        auto time_per_task = [&](const std::vector<std::string>& v) {
+            const auto all   = tm.all();
+            const auto start = hr_clock::now();
+
+            for (std::size_t i = 0; i < n; ++i) {
+                for (auto&& p : v) {
+                    for (auto* t : all) {
+                        if (t->name_matches(p))
+                            ++found;
+                    }
+                }
+            }
+
+            return hr_clock::now() - start;
+        };
+
+        // `mob list -a task...` and `mob build task...` disable all tasks and then
+        // enable the given ones through command line options; this sets every
+        // task to its current value so nothing changes
+        std::vector<std::string> opts;
+        for (auto* t : tm.all()) {
+            opts.push_back(std::format("{}:task/enabled={}", t->name(),
+                                       (t->enabled() ? "true" : "false")));
+        }
+
+        // warm up, builds the index
+        time_find(names);
+
+        const auto indexed_names  = time_find(names);
+        const auto indexed_globs  = time_find(globs);
+        const auto indexed_alias  = time_find(aliases);
+        const auto per_task_names = time_per_task(names);
+        const auto per_task_globs = time_per_task(globs);
+        const auto cmd            = bench_cmd_options(opts, n);
+
+        auto per = [&](std::chrono::nanoseconds d, std::size_t count) {
+            if (count == 0)
+                return 0.0;
+
+            return static_cast<double>(d.count()) / static_cast<double>(n * count);
+        };
+
+        u8cout << std::format("{} tasks, {} names, {} globs, {} aliases, {} "
+                              "iterations, {} matches\n",
+                              tm.all().size(), names.size(), globs.size(),
+                              aliases.size(), n, found)
+               << std::format("  names:    {:>10.0f} ns per lookup, {:.0f} ns "
+                              "matching every task\n",
+                              per(indexed_names, names.size()),
+                              per(per_task_names, names.size()))
+               << std::format("  globs:    {:>10.0f} ns per lookup, {:.0f} ns "
+                              "matching every task\n",
+                              per(indexed_globs, globs.size()),
+                              per(per_task_globs, globs.size()))
+               << std::format("  aliases:  {:>10.0f} ns per lookup\n",
+                              per(indexed_alias, aliases.size()))
+               << std::format("  enabled:  {:>10.0f} ns per option\n",
+                              per(cmd, opts.size()));
+    }
+
+    bool bench_command::fuzz_ini()
+    {
+        const auto n = iterations(10000);
+
+        // the inis that were loaded are the seeds
+        std::vector<std::string> seeds;
+        for (auto&& ini : inis_)
+            seeds.push_back(op::read_text_file(gcx(), encodings::dont_know, ini));
+
+        std::mt19937 rng(seed_);
+
+        auto random = [&](std::size_t max) {
+            return (max == 0 ? 0 : static_cast<std::size_t>(rng() % max));
+        };
+
+        // characters that mean something in an ini
+        const std::string_view special = "[]=:#; \t\r\n\"*";
+
+        // libFuzzer-style mutations on the bytes of a seed
+        auto mutate = [&](std::string s) {
+            const auto count = 1 + random(8);
+
+            for (std::size_t m = 0; m < count; ++m) {
+                const auto pos = random(s.size());
+
+                switch (random(6)) {
+                case 0:  // flip a bit
+                    if (!s.empty())
+                        s[pos] ^= static_cast<char>(1 << random(8));
+                    break;
+
+                case 1:  // insert a special character
+                    s.insert(pos, 1, special[random(special.size())]);
+                    break;
+
+                case 2:  // insert any byte
+                    s.insert(pos, 1, static_cast<char>(random(256)));
+                    break;
+
+                case 3:  // erase a range
+                    s.erase(pos, random(16));
+                    break;
+
+                case 4:  // copy a range somewhere else
+                {
+                    const auto part = s.substr(pos, random(64));
+                    s.insert(random(s.size()), part);
+                    break;
+                }
+
+                case 5:  // truncate
+                    s.resize(pos);
+                    break;
+                }
+            }
+
+            return s;
+        };
+
+        // the current input is always in this file, so it's still there if
+        // parse_ini() crashes
+        const auto file = make_temp_file();
+        u8cout << "current input is in " << path_to_utf8(file) << "\n";
+
+        std::size_t parsed = 0, rejected = 0, failed = 0;
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto input = mutate(seeds[random(seeds.size())]);
+
+            {
+                std::ofstream out(file, std::ios::binary);
+                out.write(input.data(), static_cast<std::streamsize>(input.size()));
+            }
+
+            // ini errors are expected and would flood the output
+            context::captured_logs logs;
+            context::capture_logs(&logs);
+
+            std::string error;
+
+            try {
+                parse_ini(file);
+                ++parsed;
+            }
+            catch (bailed&) {
+                ++rejected;
+            }
+            catch (std::exception& e) {
+                error = e.what();
+            }
+            catch (...) {
+                error = "unknown exception";
+            }
+
+            context::capture_logs(nullptr);
+
+            if (!error.empty()) {
+                ++failed;
+
+                const auto saved =
+                    fs::current_path() / std::format("mob_fuzz_{}.ini", i);
+
+                std::ofstream out(saved, std::ios::binary);
+                out.write(input.data(), static_cast<std::streamsize>(input.size()));
+
+                u8cout << std::format("input {} threw '{}', saved as {}\n", i, error,
+                                      path_to_utf8(saved));
+            }
+        }
+
+        op::delete_file(gcx(), file, op::optional);
+
+        u8cout << std::format("{} inputs (seed {}): {} parsed, {} rejected, "
+                              "{} failed\n",
+                              n, seed_, parsed, rejected, failed);
+
+        return (failed == 0);
+    }
+
+}  // namespace mob
@@ -4,6 +4,7 @@
 #include "../core/ini.h"
 #include "../core/op.h"
 #include "../tasks/task_manager.h"
+#include "../tools/tools.h"
 #include "commands.h"
 
 namespace mob {
@@ -84,6 +85,13 @@ namespace mob {
                    "when --reextract is given, directories controlled by git will "
                    "be deleted even if they contain uncommitted changes",
 
+               (clipp::option("-j", "--jobs") &
+                clipp::integer("COUNT").call([&](const char* s) {
+                    jobs_ = std::stoi(s);
+                })) %
+                   "maximum number of parallel jobs for all builds combined, "
+                   "defaults to the number of cores",
+
                (clipp::option("--keep-msbuild") >> keep_msbuild_) %
                    "don't terminate msbuild.exe instances after building",
 
@@ -146,6 +154,9 @@ namespace mob {
                 common.options.push_back("_override:task/revert_ts=false");
         }
 
+        if (jobs_)
+            common.options.push_back(std::format("global/jobs={}", *jobs_));
+
         if (!tasks_.empty())
             set_task_enabled_flags(tasks_);
     }
@@ -160,6 +171,19 @@ namespace mob {
             if (!keep_msbuild_)
                 terminate_msbuild();
 
+            for (auto&& s : cmake::compiler_cache_stats()) {
+                const auto total = s.hits + s.misses + s.uncacheable;
+                if (total == 0)
+                    continue;
+
+                gcx().info(context::generic,
+                           "compiler cache: {}: {}/{} hits ({}%), {} uncacheable",
+                           s.project, s.hits, total, (s.hits * 100) / total,
+                           s.uncacheable);
+            }
+
+            show_build_timings();
+
             mob::gcx().info(mob::context::generic, "mob done");
             return 0;
         }
@@ -169,6 +193,29 @@ namespace mob {
         }
     }
 
+    void build_command::show_build_timings()
+    {
+        // only the longest ones are shown on the console, everything else is
+        // in the log
+        const std::size_t shown = 10;
+
+        const auto timings = build_timings();
+        if (timings.empty())
+            return;
+
+        gcx().info(context::generic, "longest builds:");
+
+        for (std::size_t i = 0; i < timings.size(); ++i) {
+            const auto& t = timings[i];
+            const auto lv =
+                (i < shown ? context::level::info : context::level::debug);
+            const auto s  = std::chrono::duration<double>(t.time).count();
+
+            gcx().log(context::generic, lv, "  {:>8.1f}s  {}/{}", s, t.project,
+                      t.target);
+        }
+    }
+
     void build_command::create_prefix_ini()
     {
         const auto prefix = conf().path().prefix();
@@ -2,6 +2,7 @@
 #include "commands.h"
 #include "../core/conf.h"
 #include "../core/ini.h"
+#include "../core/profile.h"
 #include "../net.h"
 #include "../tasks/task_manager.h"
 #include "../tools/tools.h"
@@ -77,7 +78,11 @@ namespace mob {
 
                (clipp::option("--no-default-inis") >> o.no_default_inis) %
                    "disables auto loading of ini files, only uses --ini; the first "
-                   "--ini must be the master ini file";
+                   "--ini must be the master ini file",
+
+               (clipp::option("--profile-startup") >> o.profile_startup) %
+                   "shows how long startup took and writes a trace to "
+                   "mob-startup.json in the current directory";
     }
 
     void command::force_exit_code(int code)
@@ -139,6 +144,7 @@ namespace mob {
         }
 
         try {
+            profile_span span("find inis");
             inis_ = find_inis(!o.no_default_inis, o.inis, verbose);
             return 0;
         }
@@ -168,19 +174,30 @@ namespace mob {
 
     int command::run()
     {
+        if (common.profile_startup)
+            enable_profile(fs::current_path() / "mob-startup.json");
+
         if (help_) {
             help(group(), do_doc());
             return 0;
         }
 
-        if (flags_ & requires_options) {
-            const auto r = load_options();
-            if (r != 0)
-                return r;
+        {
+            profile_span span("dispatch " + meta().name);
+
+            if (flags_ & requires_options) {
+                const auto r = load_options();
+                if (r != 0)
+                    return r;
+            }
+
+            if (flags_ & handle_sigint)
+                set_sigint_handler();
         }
 
-        if (flags_ & handle_sigint)
-            set_sigint_handler();
+        // everything until now is startup; the spans recorded while the command
+        // runs, like vcvars, are still reported
+        record_profile_span("startup", {}, timestamp());
 
         const auto r = do_run();
 
@@ -192,14 +209,19 @@ namespace mob {
 
     int command::load_options()
     {
+        profile_span span("load options");
+
         const int r = prepare_options(false);
         if (r != 0)
             return r;
 
         init_options(inis_, common.options);
 
-        for (auto&& line : format_options())
-            gcx().trace(context::conf, "{}", line);
+        // formatting the options waits for all the paths to be found
+        if (context::enabled(context::level::trace)) {
+            for (auto&& line : format_options())
+                gcx().trace(context::conf, "{}", line);
+        }
 
         if (!verify_options())
             return 1;
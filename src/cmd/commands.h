@@ -26,6 +26,7 @@ namespace mob {
             std::vector<std::string> inis;
             bool no_default_inis = false;
             bool dump_inis       = false;
+            bool profile_startup = false;
             std::string prefix;
         };
 
@@ -205,11 +206,16 @@ namespace mob {
         bool ignore_uncommitted_ = false;
         bool keep_msbuild_       = false;
         std::optional<bool> revert_ts_;
+        std::optional<int> jobs_;
 
         // creates a bare bones ini file in the prefix so mob can be invoked in any
         // directory below it
         //
         void create_prefix_ini();
+
+        // logs the targets that took the longest to build, see build_timings()
+        //
+        void show_build_timings();
     };
 
     // applies a pr
@@ -338,7 +344,15 @@ namespace mob {
         std::string do_doc() override;
 
     private:
-        enum class modes { none = 0, set_remotes, add_remote, ignore_ts, branches };
+        enum class modes {
+            none = 0,
+            set_remotes,
+            add_remote,
+            ignore_ts,
+            branches,
+            status,
+            maintain
+        };
 
         modes mode_ = modes::none;
         std::string username_;
@@ -346,21 +360,33 @@ namespace mob {
         std::string key_;
         std::string remote_;
         std::string path_;
+        int jobs_          = 0;
         bool tson_         = false;
         bool nopush_       = false;
         bool push_default_ = false;
         bool all_branches_ = false;
+        bool timings_      = false;
 
         void do_set_remotes();
-        void do_set_remotes(const fs::path& r);
-
         void do_add_remote();
-        void do_add_remote(const fs::path& r);
-
         void do_ignore_ts();
-        void do_ignore_ts(const fs::path& r);
-
         void do_branches();
+        void do_status();
+        void do_maintain();
+
+        // runs f(i, out) for each repo in parallel, at most --jobs at the same
+        // time; `i` is the index of the repo in `repos` and anything written to
+        // `out` is printed once all the repos are done, in the same order as
+        // `repos`
+        //
+        // bails out after printing if f() failed for any repo
+        //
+        void for_each_repo(const std::vector<fs::path>& repos,
+                           std::function<void(std::size_t, std::string&)> f);
+
+        // the repo given on the command line, or all of them
+        //
+        std::vector<fs::path> selected_repos() const;
 
         std::vector<fs::path> get_repos() const;
     };
@@ -420,4 +446,48 @@ namespace mob {
         variable var_;
     };
 
+    // microbenchmarks for mob's own startup paths, see bench.cpp
+    //
+    class bench_command : public command {
+    public:
+        bench_command();
+        meta_t meta() const override;
+
+    protected:
+        clipp::group do_group() override;
+        int do_run() override;
+        std::string do_doc() override;
+
+    private:
+        enum class benchmark { conf, ini, tasks, fuzz };
+
+        benchmark what_ = benchmark::conf;
+        std::optional<int> iterations_;
+        unsigned int seed_ = 0;
+
+        // returns the number of iterations from the command line or `def`
+        //
+        std::size_t iterations(std::size_t def) const;
+
+        // resolves all task options, frozen and not
+        //
+        void bench_conf();
+
+        // parses and processes a generated ini with overrides for every task
+        // option of every task, and the same overrides as command line options
+        //
+        void bench_ini();
+
+        // looks up every task name, alias and the globs of the aliases, both
+        // through the task_manager's index and by matching every task like
+        // before, and processes options that enable or disable every task
+        //
+        void bench_tasks();
+
+        // feeds mutated versions of the loaded inis to parse_ini(), returns false
+        // if anything other than an ini error was thrown
+        //
+        bool fuzz_ini();
+    };
+
 }  // namespace mob
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "../tasks/tasks.h"
 #include "../tools/tools.h"
+#include "../utility/threading.h"
 #include "commands.h"
 
 namespace mob {
@@ -19,6 +20,10 @@ namespace mob {
 
             (clipp::option("-h", "--help") >> help_) % ("shows this message"),
 
+            (clipp::option("-j", "--jobs") & clipp::value("COUNT") >> jobs_) %
+                "maximum number of repos processed at the same time, defaults "
+                "to the number of cores",
+
             "set-remotes" %
                     (clipp::command("set-remotes").set(mode_, modes::set_remotes),
                      (clipp::required("-u", "--username") &
@@ -71,7 +76,20 @@ namespace mob {
 
                 "branches" % (clipp::command("branches").set(mode_, modes::branches),
                               clipp::option("-a", "--all").set(all_branches_) %
-                                  "shows all branches, including those on master"));
+                                  "shows all branches, including those on master")
+
+                |
+
+                "status" % (clipp::command("status").set(mode_, modes::status),
+                            clipp::option("-a", "--all").set(all_branches_) %
+                                "shows all repos, including clean ones that are up "
+                                "to date")
+
+                |
+
+                "maintain" % (clipp::command("maintain").set(mode_, modes::maintain),
+                              clipp::option("-t", "--timings").set(timings_) %
+                                  "times status and fetch before and after"));
     }
 
     int git_command::do_run()
@@ -97,6 +115,16 @@ namespace mob {
             break;
         }
 
+        case modes::status: {
+            do_status();
+            break;
+        }
+
+        case modes::maintain: {
+            do_maintain();
+            break;
+        }
+
         case modes::none:
         default:
             u8cerr << "bad git mode " << static_cast<int>(mode_) << "\n";
@@ -127,30 +155,35 @@ namespace mob {
                "\n"
                "branches\n"
                "  Lists all git repos that are not on master. With -a, show all \n"
-               "  repos and their current branch.";
+               "  repos and their current branch.\n"
+               "\n"
+               "status\n"
+               "  Lists all git repos that have uncommitted changes or are ahead or\n"
+               "  behind their upstream branch. This doesn't fetch, it uses whatever\n"
+               "  was fetched last. With -a, shows all repos.\n"
+               "\n"
+               "maintain\n"
+               "  Writes the commit-graph and multi-pack-index, packs loose objects\n"
+               "  and does an incremental repack in all repos. With --timings, times\n"
+               "  `git status` and `git fetch --dry-run` before and after.\n"
+               "\n"
+               "Repos are processed in parallel, see --jobs. The output for each repo\n"
+               "is shown once all of them are done.";
     }
 
     void git_command::do_set_remotes()
     {
-        if (path_.empty()) {
-            const auto repos = get_repos();
-
-            for (auto&& r : repos)
-                do_set_remotes(r);
-        }
-        else {
-            do_set_remotes(path_);
-        }
-    }
+        const auto repos = selected_repos();
 
-    void git_command::do_set_remotes(const fs::path& r)
-    {
-        u8cout << "setting up " << path_to_utf8(r.filename()) << "\n";
+        for_each_repo(repos, [&](std::size_t i, std::string& out) {
+            const auto& r = repos[i];
+            out += "setting up " + path_to_utf8(r.filename()) + "\n";
 
-        git_wrap(r).set_credentials(username_, email_);
+            git_wrap(r).set_credentials(username_, email_);
 
-        git_wrap(r).set_origin_and_upstream_remotes(username_, key_, nopush_,
-                                                    push_default_);
+            git_wrap(r).set_origin_and_upstream_remotes(username_, key_, nopush_,
+                                                        push_default_);
+        });
     }
 
     void git_command::do_add_remote()
@@ -158,21 +191,14 @@ namespace mob {
         u8cout << "adding remote '" << remote_ << "' "
                << "from '" << username_ << "' to repos\n";
 
-        if (path_.empty()) {
-            const auto repos = get_repos();
+        const auto repos = selected_repos();
 
-            for (auto&& r : repos)
-                do_add_remote(r);
-        }
-        else {
-            do_add_remote(path_);
-        }
-    }
+        for_each_repo(repos, [&](std::size_t i, std::string& out) {
+            const auto& r = repos[i];
+            out += path_to_utf8(r.filename()) + "\n";
 
-    void git_command::do_add_remote(const fs::path& r)
-    {
-        u8cout << path_to_utf8(r.filename()) << "\n";
-        git_wrap(r).add_remote(remote_, username_, key_, push_default_);
+            git_wrap(r).add_remote(remote_, username_, key_, push_default_);
+        });
     }
 
     void git_command::do_ignore_ts()
@@ -182,41 +208,171 @@ namespace mob {
         else
             u8cout << "un-ignoring .ts files\n";
 
-        if (path_.empty()) {
-            const auto repos = get_repos();
+        const auto repos = selected_repos();
 
-            for (auto&& r : repos)
-                do_ignore_ts(r);
-        }
-        else {
-            do_ignore_ts(path_);
-        }
-    }
+        for_each_repo(repos, [&](std::size_t i, std::string& out) {
+            const auto& r = repos[i];
+            out += path_to_utf8(r.filename()) + "\n";
 
-    void git_command::do_ignore_ts(const fs::path& r)
-    {
-        u8cout << path_to_utf8(r.filename()) << "\n";
-        git_wrap(r).ignore_ts(tson_);
+            git_wrap(r).ignore_ts(tson_);
+        });
     }
 
     void git_command::do_branches()
     {
+        const auto repos = get_repos();
+        std::vector<std::string> branches(repos.size());
+
+        for_each_repo(repos, [&](std::size_t i, std::string&) {
+            branches[i] = git_wrap(repos[i]).current_branch();
+        });
+
         std::vector<std::pair<std::string, std::string>> v;
 
-        for (auto&& r : get_repos()) {
-            const auto b = git_wrap(r).current_branch();
+        for (std::size_t i = 0; i < repos.size(); ++i) {
+            const auto& b = branches[i];
             if (b == "master" && !all_branches_)
                 continue;
 
             if (b.empty())
-                v.push_back({r.filename().string(), "detached head"});
+                v.push_back({repos[i].filename().string(), "detached head"});
             else
-                v.push_back({r.filename().string(), b});
+                v.push_back({repos[i].filename().string(), b});
         }
 
         u8cout << table(v, 0, 3) << "\n";
     }
 
+    void git_command::do_status()
+    {
+        const auto repos = get_repos();
+        std::vector<git_wrap::status_info> status(repos.size());
+
+        for_each_repo(repos, [&](std::size_t i, std::string&) {
+            status[i] = git_wrap(repos[i]).status();
+        });
+
+        std::vector<std::pair<std::string, std::string>> v;
+
+        for (std::size_t i = 0; i < repos.size(); ++i) {
+            const auto& si = status[i];
+
+            std::vector<std::string> what;
+
+            if (si.branch.empty())
+                what.push_back("detached head");
+            else
+                what.push_back(si.branch);
+
+            if (si.dirty)
+                what.push_back("dirty");
+
+            if (si.upstream.empty() && !si.branch.empty())
+                what.push_back("no upstream");
+
+            if (si.ahead > 0)
+                what.push_back(std::format("ahead {}", si.ahead));
+
+            if (si.behind > 0)
+                what.push_back(std::format("behind {}", si.behind));
+
+            // just the branch name, nothing interesting
+            if (what.size() == 1 && !all_branches_)
+                continue;
+
+            v.push_back({repos[i].filename().string(), join(what, ", ")});
+        }
+
+        u8cout << table(v, 0, 3) << "\n";
+    }
+
+    void git_command::do_maintain()
+    {
+        const auto repos = get_repos();
+
+        // runs status and a dry fetch, returns how long each took
+        auto time_git = [](const fs::path& r) {
+            using namespace std::chrono;
+
+            git_wrap g(r);
+
+            const auto start = hr_clock::now();
+            g.status();
+            const auto status_end = hr_clock::now();
+            g.fetch_dry_run();
+            const auto fetch_end = hr_clock::now();
+
+            return std::make_pair(duration_cast<milliseconds>(status_end - start),
+                                  duration_cast<milliseconds>(fetch_end - status_end));
+        };
+
+        for_each_repo(repos, [&](std::size_t i, std::string& out) {
+            const auto& r = repos[i];
+
+            if (!timings_) {
+                git_wrap(r).maintain();
+                out += path_to_utf8(r.filename()) + "\n";
+                return;
+            }
+
+            const auto before = time_git(r);
+            git_wrap(r).maintain();
+            const auto after = time_git(r);
+
+            out += std::format("{}: status {} -> {}, fetch {} -> {}\n",
+                               path_to_utf8(r.filename()), before.first, after.first,
+                               before.second, after.second);
+        });
+    }
+
+    void git_command::for_each_repo(const std::vector<fs::path>& repos,
+                                    std::function<void(std::size_t, std::string&)> f)
+    {
+        std::vector<std::string> out(repos.size());
+        std::atomic<bool> failed = false;
+
+        {
+            std::optional<std::size_t> threads;
+            if (jobs_ > 0)
+                threads = static_cast<std::size_t>(jobs_);
+
+            thread_pool tp(threads);
+
+            for (std::size_t i = 0; i < repos.size(); ++i) {
+                tp.add([&, i] {
+                    try {
+                        f(i, out[i]);
+                    }
+                    catch (bailed&) {
+                        out[i] += path_to_utf8(repos[i].filename()) + ": failed\n";
+                        failed = true;
+                    }
+                    catch (std::exception& e) {
+                        // anything else would terminate the thread pool
+                        out[i] += std::format("{}: failed, {}\n",
+                                              path_to_utf8(repos[i].filename()),
+                                              e.what());
+                        failed = true;
+                    }
+                });
+            }
+        }
+
+        for (auto&& s : out)
+            u8cout << s;
+
+        if (failed)
+            throw bailed();
+    }
+
+    std::vector<fs::path> git_command::selected_repos() const
+    {
+        if (path_.empty())
+            return get_repos();
+        else
+            return {path_};
+    }
+
     std::vector<fs::path> git_command::get_repos() const
     {
         std::vector<fs::path> v;
@@ -8,9 +8,13 @@
 #include "env.h"
 #include "ini.h"
 #include "paths.h"
+#include "profile.h"
 
 namespace mob::details {
 
+    void set_string(std::string_view section, std::string_view key,
+                    std::string_view value);
+
     using key_value_map = std::map<std::string, std::string, std::less<>>;
     using section_map   = std::map<std::string, key_value_map, std::less<>>;
 
@@ -49,10 +53,145 @@ namespace mob::details {
         return (s == "true" || s == "yes" || s == "1");
     }
 
+    // a value of g_conf that's being looked up in a background thread, see
+    // defer_string()
+    //
+    struct deferred_value {
+        std::string section, key;
+        std::shared_future<std::string> value;
+
+        // logs from the lookup, written out by the first thread that needs the
+        // value
+        std::shared_ptr<context::captured_logs> logs;
+        bool logged = false;
+    };
+
+    // deferred values indexed by "section/key"; g_deferred_count is the size of
+    // the map and is checked first so get_string() doesn't have to lock anything
+    // once all the values that were needed have been found
+    static std::map<std::string, deferred_value, std::less<>> g_deferred;
+    static std::mutex g_deferred_mutex;
+    static std::atomic<std::size_t> g_deferred_count = 0;
+
+    // lookup threads, joined in join_lookups(); protected by g_deferred_mutex
+    static std::vector<std::thread> g_deferred_threads;
+
+    // "section/key" of the value the current thread is looking up, if any
+    static thread_local std::string t_deferring;
+
+    // starts a thread that calls `f` and sets `section/key` to its result;
+    // get_string() will block until it's done if that key is needed
+    //
+    // the value in g_conf is left alone until then, so the lookup itself can
+    // still get the value of its own key from the ini
+    //
+    void defer_string(std::string_view section, std::string_view key,
+                      std::function<std::string()> f)
+    {
+        auto name    = std::format("{}/{}", section, key);
+        auto promise = std::make_shared<std::promise<std::string>>();
+        auto logs    = std::make_shared<context::captured_logs>();
+
+        std::scoped_lock lock(g_deferred_mutex);
+
+        g_deferred[name] = {std::string(section), std::string(key),
+                            promise->get_future().share(), logs};
+
+        g_deferred_count.store(g_deferred.size(), std::memory_order_release);
+
+        g_deferred_threads.push_back(start_thread([name, f, promise, logs] {
+            t_deferring = name;
+            context::capture_logs(logs.get());
+
+            {
+                profile_span span("find " + name);
+
+                try {
+                    promise->set_value(f());
+                }
+                catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+            }
+
+            context::capture_logs(nullptr);
+        }));
+    }
+
+    // if `section/key` is still being looked up, waits for it and puts the
+    // result in g_conf; rethrows if the lookup failed
+    //
+    void wait_for_deferred(std::string_view section, std::string_view key)
+    {
+        if (g_deferred_count.load(std::memory_order_acquire) == 0)
+            return;
+
+        const auto name = std::format("{}/{}", section, key);
+
+        // a lookup getting its own value from the ini
+        if (name == t_deferring)
+            return;
+
+        std::shared_future<std::string> value;
+
+        {
+            std::scoped_lock lock(g_deferred_mutex);
+
+            auto itor = g_deferred.find(name);
+            if (itor == g_deferred.end())
+                return;
+
+            value = itor->second.value;
+        }
+
+        // only shows up in the profile if the lookup wasn't done yet
+        if (value.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            profile_span span("wait for " + name);
+            value.wait();
+        }
+
+        std::scoped_lock lock(g_deferred_mutex);
+
+        // another thread might have got there first
+        auto itor = g_deferred.find(name);
+        if (itor == g_deferred.end())
+            return;
+
+        if (!itor->second.logged) {
+            context::emit_captured(*itor->second.logs);
+            itor->second.logged = true;
+        }
+
+        // throws if the lookup failed; the value stays deferred so every thread
+        // that needs it fails the same way
+        set_string(section, key, value.get());
+
+        g_deferred.erase(itor);
+        g_deferred_count.store(g_deferred.size(), std::memory_order_release);
+    }
+
+    // waits for all the deferred values, used when all the options are needed
+    //
+    void wait_for_all_deferred()
+    {
+        std::vector<std::pair<std::string, std::string>> keys;
+
+        {
+            std::scoped_lock lock(g_deferred_mutex);
+            for (auto&& [name, d] : g_deferred)
+                keys.emplace_back(d.section, d.key);
+        }
+
+        for (auto&& [section, key] : keys)
+            wait_for_deferred(section, key);
+    }
+
     // returns a string from conf, bails out if it doesn't exist
     //
     std::string get_string(std::string_view section, std::string_view key)
     {
+        wait_for_deferred(section, key);
+
         auto sitor = g_conf.find(section);
         if (sitor == g_conf.end())
             gcx().bail_out(context::conf, "[{}] doesn't exist", section);
@@ -192,6 +331,171 @@ namespace mob::details {
         return bool_from_string(s);
     }
 
+    // allows for looking up std::string keys with a std::string_view
+    //
+    struct string_hash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view s) const
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    template <class T>
+    using string_hash_map =
+        std::unordered_map<std::string, T, string_hash, std::equal_to<>>;
+
+    // all the task options for one task, resolved once all the inis and command
+    // line options have been processed, see freeze_task_options()
+    //
+    struct frozen_task {
+        // values indexed like frozen_options::keys
+        std::vector<std::string> values;
+
+        // the same values, converted
+        std::vector<bool> bools;
+        std::vector<std::optional<int>> ints;
+
+        // empty if the value is bad, conf_task::configuration() bails out
+        std::optional<mob::config> configuration;
+    };
+
+    // all the resolved task options; a table is never modified once it's
+    // published, conf_task keeps the one that was current when it was created
+    //
+    struct frozen_options {
+        // index of each task option in frozen_task::values
+        string_hash_map<std::size_t> keys;
+
+        // one entry per task
+        std::vector<frozen_task> tasks;
+
+        // index in `tasks` for every task name, including alternate names
+        string_hash_map<std::size_t> names;
+    };
+
+    // current table, null before freeze_task_options() and after an option was
+    // set, in which case it's built again the next time it's needed; all three
+    // are protected by g_frozen_mutex because tasks are looked up from other
+    // threads, such as the lookups started by resolve_paths()
+    static std::shared_ptr<const frozen_options> g_frozen;
+    static bool g_frozen_enabled = false;
+    static std::mutex g_frozen_mutex;
+
+    // resolves every task option for every task
+    //
+    // options set for a task are always stored under the task's main name, see
+    // process_option(), so the result only depends on that name
+    //
+    std::shared_ptr<const frozen_options> build_frozen_options()
+    {
+        auto f = std::make_shared<frozen_options>();
+
+        const auto& defaults = g_tasks[""];
+
+        for (auto&& [k, unused] : defaults)
+            f->keys.emplace(k, f->keys.size());
+
+        for (const auto* t : task_manager::instance().all()) {
+            frozen_task ft;
+
+            // the map is ordered, same order as the indices above
+            for (auto&& [k, unused] : defaults) {
+                auto v = get_string_for_task(t->names(), k);
+
+                int i        = 0;
+                const auto r = std::from_chars(v.data(), v.data() + v.size(), i);
+
+                if (r.ec == std::errc() && r.ptr == v.data() + v.size())
+                    ft.ints.push_back(i);
+                else
+                    ft.ints.push_back({});
+
+                ft.bools.push_back(bool_from_string(v));
+                ft.values.push_back(std::move(v));
+            }
+
+            const auto c = f->keys.find("configuration");
+            if (c != f->keys.end()) {
+                for (const auto& [value_c, value_s] : s_configuration_values) {
+                    if (case_insensitive_equals(value_s, ft.values[c->second]))
+                        ft.configuration = value_c;
+                }
+            }
+
+            f->tasks.push_back(std::move(ft));
+
+            for (auto&& name : t->names())
+                f->names.emplace(name, f->tasks.size() - 1);
+        }
+
+        return f;
+    }
+
+    // forgets the resolved options, called when an option is set; conf_task
+    // objects that were created before keep the old values
+    //
+    void thaw_task_options()
+    {
+        std::scoped_lock lock(g_frozen_mutex);
+        g_frozen.reset();
+    }
+
+    // resolves every task option for every task once so conf_task doesn't have
+    // to go through get_string_for_task() and convert the value each time; this
+    // is called at the end of init_options()
+    //
+    void freeze_task_options()
+    {
+        auto f = build_frozen_options();
+
+        std::scoped_lock lock(g_frozen_mutex);
+        g_frozen         = std::move(f);
+        g_frozen_enabled = true;
+    }
+
+    // returns the current table, building it again if an option was set since
+    // the last time; null if the options were never frozen
+    //
+    std::shared_ptr<const frozen_options> frozen_task_options()
+    {
+        std::scoped_lock lock(g_frozen_mutex);
+
+        if (!g_frozen && g_frozen_enabled)
+            g_frozen = build_frozen_options();
+
+        return g_frozen;
+    }
+
+    // returns the resolved options for the task, null if the task doesn't exist
+    //
+    const frozen_task* find_frozen_task(const frozen_options& f,
+                                        const std::vector<std::string>& task_names)
+    {
+        if (task_names.empty())
+            return nullptr;
+
+        auto itor = f.names.find(task_names[0]);
+        if (itor == f.names.end())
+            return nullptr;
+
+        return &f.tasks[itor->second];
+    }
+
+    // returns the index of the given task option in frozen_task::values, empty if
+    // it doesn't exist
+    //
+    std::optional<std::size_t> find_frozen_key(const frozen_options& f,
+                                               std::string_view key)
+    {
+        auto itor = f.keys.find(key);
+        if (itor == f.keys.end())
+            return {};
+
+        return itor->second;
+    }
+
     // sets the given task option, bails out if the option doesn't exist
     //
     void set_string_for_task(const std::string& task_name, const std::string& key,
@@ -201,6 +505,9 @@ namespace mob::details {
         get_string_for_task({task_name}, key);
 
         g_tasks[task_name][key] = std::move(value);
+
+        // the resolved options are stale
+        thaw_task_options();
     }
 
     // sets the given task option, adds it if it doesn't exist; used when setting
@@ -240,6 +547,9 @@ namespace mob {
 
     std::vector<std::string> format_options()
     {
+        // show the paths that were found instead of the ones from the inis
+        details::wait_for_all_deferred();
+
         // don't log private stuff
         auto hide = [](std::string_view section, std::string_view key) {
             if (key == "github_key")
@@ -320,10 +630,19 @@ namespace mob {
         details::g_output_log_level = details::get_int("global", "output_log_level");
         details::g_file_log_level   = details::get_int("global", "file_log_level");
         details::g_dry              = details::get_bool("global", "dry");
+
+        cpu_pool::instance().set_size(
+            static_cast<std::size_t>(std::max(0, details::get_int("global", "jobs"))));
+
+        // in MB in the ini
+        cpu_pool::instance().set_memory_threshold(
+            static_cast<std::uint64_t>(
+                std::max(0, details::get_int("global", "min_free_memory"))) *
+            1024 * 1024);
     }
 
-    // sets an option `key` in the `paths` section; if the path is currently empty,
-    // sets it using `f` (which is either a callable or a string)
+    // returns the option `key` in the `paths` section; if the path is currently
+    // empty, gets it from `f` (which is either a callable or a string)
     //
     // in any case, makes it absolute and canonical, bails out if the path does not
     // exist
@@ -331,7 +650,7 @@ namespace mob {
     // this is used for paths that should already exist (qt, vs, etc.)
     //
     template <class F>
-    void set_path_if_empty(std::string_view key, F&& f)
+    fs::path find_path_if_empty(std::string_view key, F&& f)
     {
         // current value
         fs::path p = conf().path().get(key);
@@ -353,8 +672,26 @@ namespace mob {
             p = fs::canonical(p);
         }
 
-        // new value
-        details::set_string("paths", key, path_to_utf8(p));
+        return p;
+    }
+
+    // sets the option `key` in the `paths` section using find_path_if_empty()
+    //
+    template <class F>
+    void set_path_if_empty(std::string_view key, F&& f)
+    {
+        details::set_string("paths", key, path_to_utf8(find_path_if_empty(key, f)));
+    }
+
+    // same as set_path_if_empty(), but the path is found in a background thread
+    // and only waited for when something needs it
+    //
+    template <class F>
+    void defer_path_if_empty(std::string_view key, F f)
+    {
+        details::defer_string("paths", key, [key, f] {
+            return path_to_utf8(find_path_if_empty(key, f));
+        });
     }
 
     // sets an option `key` in the `paths` section:
@@ -385,6 +722,183 @@ namespace mob {
         details::set_string("paths", key, path_to_utf8(p));
     }
 
+    // a path found by resolve_paths() along with the modification time of its
+    // stamp file when it was found, see discover()
+    //
+    struct discovery_entry {
+        std::string value;
+        std::string stamp;
+    };
+
+    // hash of everything the lookups in resolve_paths() depend on and the cached
+    // entries; the lookups run in parallel, so the entries are behind a mutex
+    static std::uint64_t g_discovery_key = 0;
+    static std::map<std::string, discovery_entry, std::less<>> g_discovery;
+    static std::mutex g_discovery_mutex;
+
+    // fnv1a(), every string is followed by a null byte so consecutive strings
+    // can't be confused with each other
+    //
+    std::uint64_t discovery_hash(std::string_view s, std::uint64_t h)
+    {
+        return fnv1a({"", 1}, fnv1a(s, h));
+    }
+
+    // modification time of the given file, empty if it doesn't exist, which
+    // never matches a stamp for an existing file
+    //
+    std::string discovery_stamp(const fs::path& p)
+    {
+        if (p.empty())
+            return {};
+
+        std::error_code ec;
+        const auto t = fs::last_write_time(p, ec);
+
+        if (ec)
+            return {};
+
+        return std::to_string(t.time_since_epoch().count());
+    }
+
+    fs::path discovery_cache_file()
+    {
+        return conf().path().prefix() / "mob_discovery.cache";
+    }
+
+    // finding vs, qt, iscc, etc. spawns vswhere and probes a bunch of
+    // directories, which is slow and done on every invocation, even `mob list`,
+    // so the results are remembered in the prefix
+    //
+    // the cache is only used if its key matches: a hash of mob.exe, the
+    // contents of the inis, the command line options and the environment
+    // variables the lookups use; each entry is also discarded if the
+    // modification time of its stamp file has changed, see discover()
+    //
+    void load_discovery_cache(const std::vector<fs::path>& inis,
+                              const std::vector<std::string>& opts)
+    {
+        const auto exe  = mob_exe_path();
+        std::uint64_t h = discovery_hash(path_to_utf8(exe), fnv1a(""));
+        h               = discovery_hash(discovery_stamp(exe), h);
+
+        for (auto&& ini : inis) {
+            h = discovery_hash(path_to_utf8(ini), h);
+            h = discovery_hash(
+                op::read_text_file(gcx(), encodings::dont_know, ini, op::optional), h);
+        }
+
+        for (auto&& o : opts)
+            h = discovery_hash(o, h);
+
+        for (auto&& v : {"PATH", "VCPKG_ROOT", "TEMP", "TMP"})
+            h = discovery_hash(this_env::get(v), h);
+
+        g_discovery_key = h;
+        g_discovery.clear();
+
+        // paths are not checked for existence in dry mode, don't remember them
+        if (conf().global().dry() || !conf().global().get<bool>("discovery_cache"))
+            return;
+
+        const auto file = discovery_cache_file();
+        if (!fs::exists(file))
+            return;
+
+        const auto lines = split(
+            op::read_text_file(gcx(), encodings::utf8, file, op::optional), "\r\n");
+
+        if (lines.empty() || lines[0] != std::format("key {:016x}", h)) {
+            gcx().debug(context::conf, "discovery cache {} is stale", file);
+            return;
+        }
+
+        // each line is "name\tstamp\tvalue", the value can be empty
+        for (std::size_t i = 1; i < lines.size(); ++i) {
+            const auto& line = lines[i];
+
+            const auto tab1 = line.find('\t');
+            if (tab1 == std::string::npos)
+                continue;
+
+            const auto tab2 = line.find('\t', tab1 + 1);
+            if (tab2 == std::string::npos)
+                continue;
+
+            g_discovery[line.substr(0, tab1)] = {
+                line.substr(tab2 + 1), line.substr(tab1 + 1, tab2 - tab1 - 1)};
+        }
+
+        gcx().debug(context::conf, "loaded {} entries from discovery cache {}",
+                    g_discovery.size(), file);
+    }
+
+    // writes the discovery cache, called with g_discovery_mutex locked every time
+    // something had to be looked up; the prefix might not exist yet, in which
+    // case the next run will write it
+    //
+    void save_discovery_cache()
+    {
+        if (conf().global().dry() || !conf().global().get<bool>("discovery_cache"))
+            return;
+
+        if (!fs::exists(conf().path().prefix()))
+            return;
+
+        std::string s = std::format("key {:016x}\n", g_discovery_key);
+
+        for (auto&& [name, e] : g_discovery)
+            s += std::format("{}\t{}\t{}\n", name, e.stamp, e.value);
+
+        op::write_text_file(gcx(), encodings::utf8, discovery_cache_file(), s,
+                            op::optional);
+    }
+
+    // returns the cached value for `name` if its stamp file hasn't changed since
+    // it was found, or calls `f` and remembers its result
+    //
+    // `stamp_file` gives the file to check for a path, which should be a binary
+    // that changes when the installation is updated, such as qmake.exe; the
+    // modification time of a directory changes every time something is created
+    // or deleted in it
+    //
+    template <class F, class S>
+    auto discover(std::string_view name, F&& f, S&& stamp_file)
+    {
+        return [name, f, stamp_file] {
+            std::optional<discovery_entry> cached;
+
+            {
+                std::scoped_lock lock(g_discovery_mutex);
+
+                auto itor = g_discovery.find(name);
+                if (itor != g_discovery.end())
+                    cached = itor->second;
+            }
+
+            if (cached) {
+                const fs::path p(utf8_to_utf16(cached->value));
+
+                if (discovery_stamp(stamp_file(p)) == cached->stamp) {
+                    gcx().trace(context::conf, "{} is {} (cached)", name, p);
+                    return p;
+                }
+
+                gcx().debug(context::conf, "cached {} {} has changed, looking again",
+                            name, p);
+            }
+
+            const fs::path p = f();
+
+            std::scoped_lock lock(g_discovery_mutex);
+            g_discovery[std::string(name)] = {path_to_utf8(p),
+                                              discovery_stamp(stamp_file(p))};
+            save_discovery_cache();
+
+            return p;
+        };
+    }
+
     // `section_string` can be something like "global" or "paths", but also "task"
     // or a task-specific name like "uibase:task"
     //
@@ -508,13 +1022,41 @@ namespace mob {
 
         set_path_if_empty("pf_x86", find_program_files_x86);
         set_path_if_empty("pf_x64", find_program_files_x64);
-        set_path_if_empty("vs", find_vs);
-        set_path_if_empty("vcpkg", find_vcpkg);  // set after vs as it will use the VS
-        set_path_if_empty("qt_install", find_qt);
-        set_path_if_empty("temp_dir", find_temp_dir);
         set_path_if_empty("licenses", find_in_root("licenses"));
-        set_path_if_empty("qt_bin", qt::installation_path() / "bin");
-        set_path_if_empty("qt_translations", qt::installation_path() / "translations");
+
+        // these are expensive, so they're cached (see load_discovery_cache()) and
+        // found in parallel; accessing one of them waits until it's been found,
+        // which allows commands that don't need vs or qt to skip waiting for them
+        //
+        // lookups that need another path (vcpkg needs vs, for example) simply
+        // wait for it in their own thread
+        //
+        // each one is stamped with a file mob uses from it
+        defer_path_if_empty("vs", discover("vs", find_vs, [](const fs::path& p) {
+                                return p / "VC" / "Auxiliary" / "Build" /
+                                       "vcvarsall.bat";
+                            }));
+
+        defer_path_if_empty("vcpkg",
+                            discover("vcpkg", find_vcpkg, [](const fs::path& p) {
+                                return p / "scripts" / "buildsystems" / "vcpkg.cmake";
+                            }));
+
+        defer_path_if_empty("qt_install",
+                            discover("qt_install", find_qt, [](const fs::path& p) {
+                                return p / "bin" / "qmake.exe";
+                            }));
+
+        // this is cheap and depends on TEMP and TMP, which are not files
+        defer_path_if_empty("temp_dir", find_temp_dir);
+
+        defer_path_if_empty("qt_bin", [] {
+            return qt::installation_path() / "bin";
+        });
+
+        defer_path_if_empty("qt_translations", [] {
+            return qt::installation_path() / "translations";
+        });
 
         // second, if any of these paths are relative, they use the second argument
         // as the root; if they're empty, they combine the second and third
@@ -542,35 +1084,334 @@ namespace mob {
         // other tools (7z, jom, patch, etc.) are assumed to be in PATH (which
         // now contains third-party) or have valid absolute paths in the ini
 
-        details::set_string("tools", "vcvars", path_to_utf8(find_vcvars()));
-        details::set_string("tools", "iscc", path_to_utf8(find_iscc()));
+        details::defer_string("tools", "vcvars", [] {
+            return path_to_utf8(discover("vcvars", find_vcvars, std::identity())());
+        });
+
+        details::defer_string("tools", "iscc", [] {
+            return path_to_utf8(discover("iscc", find_iscc, std::identity())());
+        });
     }
 
-    void conf::set_log_file()
+    void join_lookups()
     {
-        // set up the log file, resolve against prefix if relative
-        fs::path log_file = conf().global().get("log_file");
-        if (log_file.is_relative())
-            log_file = conf().path().prefix() / log_file;
+        // lookups don't start other lookups, but they might be waiting on one
+        // that's in the list
+        std::vector<std::thread> threads;
 
-        context::set_log_file(log_file);
+        {
+            std::scoped_lock lock(details::g_deferred_mutex);
+            threads.swap(details::g_deferred_threads);
+        }
+
+        for (auto&& t : threads) {
+            if (t.joinable())
+                t.join();
+        }
     }
 
-    void init_options(const std::vector<fs::path>& inis,
-                      const std::vector<std::string>& opts)
-    {
-        MOB_ASSERT(!inis.empty());
+    // processing all the inis is relatively slow: they're read and parsed, and
+    // every task section is matched against all the tasks; the merged result is
+    // saved in a binary snapshot next to mob.exe and loaded directly on the next
+    // run if none of the inis have changed
+    //
+    // the snapshot contains, in order:
+    //
+    //   - "mobsnap1" and the key from ini_snapshot_key(),
+    //   - the directory a relative prefix is resolved against, empty for cwd,
+    //   - g_conf and g_tasks, each as a count of sections followed by, for each
+    //     section, its name and a count of key/value pairs, and
+    //   - the aliases, as a count followed by each name and its patterns
+    //
+    // integers are 32-bit and strings are prefixed with their length
+    //
 
-        // some logging
-        gcx().debug(context::conf, "cl: {}", std::wstring(GetCommandLineW()));
-        gcx().debug(context::conf, "using inis in order:");
+    constexpr std::string_view ini_snapshot_magic = "mobsnap1";
+
+    fs::path ini_snapshot_file(const std::vector<fs::path>& inis)
+    {
+        // one snapshot for each set of inis, it's common to have several prefixes
+        // with their own ini
+        std::uint64_t h = fnv1a("");
         for (auto&& ini : inis)
-            gcx().debug(context::conf, "  . {}", ini);
+            h = discovery_hash(path_to_utf8(ini), h);
 
-        // used to resolve a relative prefix; by default, it's resolved against cwd,
-        // but if an ini other than the master contains a prefix, use the ini's
-        // parent directory instead
-        fs::path prefix_root = fs::current_path();
+        return mob_exe_path().parent_path() /
+               std::format("mob_ini_{:016x}.snapshot", h);
+    }
+
+    // changes when mob.exe (which has the list of tasks that task sections are
+    // validated against) or any of the inis change
+    //
+    std::uint64_t ini_snapshot_key(const std::vector<fs::path>& inis)
+    {
+        const auto exe  = mob_exe_path();
+        std::uint64_t h = discovery_hash(discovery_stamp(exe), fnv1a(""));
+
+        for (auto&& ini : inis) {
+            std::error_code ec;
+            const auto size = fs::file_size(ini, ec);
+
+            h = discovery_hash(path_to_utf8(ini), h);
+            h = discovery_hash(discovery_stamp(ini), h);
+            h = discovery_hash(ec ? "" : std::to_string(size), h);
+        }
+
+        return h;
+    }
+
+    // reads the values written by save_ini_snapshot() from a mapped file; any
+    // read past the end makes ok() return false and everything else return
+    // empty values
+    //
+    class snapshot_reader {
+    public:
+        snapshot_reader(const char* p, std::size_t size) : p_(p), end_(p + size) {}
+
+        bool ok() const { return ok_; }
+
+        std::uint32_t u32()
+        {
+            std::uint32_t v = 0;
+            read(&v, sizeof(v));
+            return v;
+        }
+
+        std::uint64_t u64()
+        {
+            std::uint64_t v = 0;
+            read(&v, sizeof(v));
+            return v;
+        }
+
+        std::string_view string()
+        {
+            const auto n  = u32();
+            const char* p = p_;
+
+            if (!read(nullptr, n))
+                return {};
+
+            return {p, n};
+        }
+
+    private:
+        const char* p_;
+        const char* end_;
+        bool ok_ = true;
+
+        bool read(void* out, std::size_t n)
+        {
+            if (!ok_ || static_cast<std::size_t>(end_ - p_) < n) {
+                ok_ = false;
+                return false;
+            }
+
+            if (out)
+                std::memcpy(out, p_, n);
+
+            p_ += n;
+            return true;
+        }
+    };
+
+    // reads a section_map written by snapshot_writer::sections()
+    //
+    details::section_map read_snapshot_sections(snapshot_reader& r)
+    {
+        details::section_map sections;
+
+        const auto section_count = r.u32();
+        for (std::uint32_t i = 0; i < section_count && r.ok(); ++i) {
+            auto& kvs = sections[std::string(r.string())];
+
+            const auto kv_count = r.u32();
+            for (std::uint32_t j = 0; j < kv_count && r.ok(); ++j) {
+                std::string k(r.string());
+                kvs[std::move(k)] = r.string();
+            }
+        }
+
+        return sections;
+    }
+
+    // loads the options from the snapshot if it exists and its key matches, sets
+    // `prefix_root` to the root for a relative prefix, empty for cwd; returns
+    // false if the inis have to be processed
+    //
+    bool load_ini_snapshot(const std::vector<fs::path>& inis, fs::path& prefix_root)
+    {
+        const auto path = ini_snapshot_file(inis);
+
+        handle_ptr file(::CreateFileW(
+            path.native().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+
+        if (file.get() == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size = {};
+        if (!::GetFileSizeEx(file.get(), &size) || size.QuadPart == 0)
+            return false;
+
+        handle_ptr mapping(
+            ::CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+
+        if (!mapping)
+            return false;
+
+        const void* view = ::MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0);
+        if (!view)
+            return false;
+
+        guard unmap([&] {
+            ::UnmapViewOfFile(view);
+        });
+
+        snapshot_reader r(static_cast<const char*>(view),
+                          static_cast<std::size_t>(size.QuadPart));
+
+        if (r.string() != ini_snapshot_magic || r.u64() != ini_snapshot_key(inis)) {
+            gcx().debug(context::conf, "ini snapshot {} is stale", path);
+            return false;
+        }
+
+        const fs::path root(utf8_to_utf16(r.string()));
+
+        auto conf_sections = read_snapshot_sections(r);
+        auto task_sections = read_snapshot_sections(r);
+
+        task_manager::alias_map aliases;
+
+        const auto alias_count = r.u32();
+        for (std::uint32_t i = 0; i < alias_count && r.ok(); ++i) {
+            auto& patterns = aliases[std::string(r.string())];
+
+            const auto pattern_count = r.u32();
+            for (std::uint32_t j = 0; j < pattern_count && r.ok(); ++j)
+                patterns.emplace_back(r.string());
+        }
+
+        if (!r.ok()) {
+            gcx().debug(context::conf, "ini snapshot {} is truncated", path);
+            return false;
+        }
+
+        details::g_conf  = std::move(conf_sections);
+        details::g_tasks = std::move(task_sections);
+
+        for (auto&& [name, patterns] : aliases)
+            task_manager::instance().add_alias(name, patterns);
+
+        prefix_root = root;
+
+        gcx().debug(context::conf, "loaded options from ini snapshot {}", path);
+
+        return true;
+    }
+
+    // builds the snapshot loaded by load_ini_snapshot(), the counterpart of
+    // snapshot_reader
+    //
+    class snapshot_writer {
+    public:
+        const std::string& data() const { return out_; }
+
+        void u32(std::size_t v)
+        {
+            const auto v32 = static_cast<std::uint32_t>(v);
+            out_.append(reinterpret_cast<const char*>(&v32), sizeof(v32));
+        }
+
+        void u64(std::uint64_t v)
+        {
+            out_.append(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+
+        void string(std::string_view s)
+        {
+            u32(s.size());
+            out_.append(s);
+        }
+
+        void sections(const details::section_map& sections)
+        {
+            u32(sections.size());
+
+            for (auto&& [name, kvs] : sections) {
+                string(name);
+                u32(kvs.size());
+
+                for (auto&& [k, v] : kvs) {
+                    string(k);
+                    string(v);
+                }
+            }
+        }
+
+    private:
+        std::string out_;
+    };
+
+    // writes the snapshot loaded by load_ini_snapshot(), failures are ignored
+    //
+    void save_ini_snapshot(const std::vector<fs::path>& inis,
+                           const fs::path& prefix_root)
+    {
+        snapshot_writer w;
+
+        w.string(ini_snapshot_magic);
+        w.u64(ini_snapshot_key(inis));
+        w.string(path_to_utf8(prefix_root));
+
+        w.sections(details::g_conf);
+        w.sections(details::g_tasks);
+
+        const auto& aliases = task_manager::instance().aliases();
+        w.u32(aliases.size());
+
+        for (auto&& [name, patterns] : aliases) {
+            w.string(name);
+            w.u32(patterns.size());
+
+            for (auto&& p : patterns)
+                w.string(p);
+        }
+
+        const auto& out = w.data();
+
+        // written to a temporary file first so another mob running at the same
+        // time never maps a partial snapshot
+        const auto path = ini_snapshot_file(inis);
+        const auto tmp  = fs::path(path).concat(L".tmp");
+
+        {
+            std::ofstream f(tmp, std::ios::binary);
+            f.write(out.data(), static_cast<std::streamsize>(out.size()));
+
+            if (!f) {
+                gcx().debug(context::conf, "can't write ini snapshot {}", tmp);
+                return;
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+
+        if (ec) {
+            gcx().debug(context::conf, "can't write ini snapshot {}, {}", path,
+                        ec.message());
+            fs::remove(tmp, ec);
+        }
+    }
+
+    // processes all the inis in order, returns the directory a relative prefix
+    // is resolved against if an ini other than the master changed the prefix,
+    // empty otherwise
+    //
+    fs::path process_inis(const std::vector<fs::path>& inis)
+    {
+        fs::path prefix_root;
 
         // true for the first ini, will add values to the configuration maps instead
         // of setting them, which throws if the option doesn't exist
@@ -600,7 +1441,53 @@ namespace mob {
             master = false;
         }
 
+        return prefix_root;
+    }
+
+    void conf::set_log_file()
+    {
+        // set up the log file, resolve against prefix if relative
+        fs::path log_file = conf().global().get("log_file");
+        if (log_file.is_relative())
+            log_file = conf().path().prefix() / log_file;
+
+        context::set_log_file(log_file);
+    }
+
+    void init_options(const std::vector<fs::path>& inis,
+                      const std::vector<std::string>& opts)
+    {
+        MOB_ASSERT(!inis.empty());
+
+        // some logging
+        gcx().debug(context::conf, "cl: {}", std::wstring(GetCommandLineW()));
+        gcx().debug(context::conf, "using inis in order:");
+        for (auto&& ini : inis)
+            gcx().debug(context::conf, "  . {}", ini);
+
+        // used to resolve a relative prefix; by default, it's resolved against cwd,
+        // but if an ini other than the master contains a prefix, use the ini's
+        // parent directory instead
+        //
+        // the inis are only processed if they changed since the last run, see
+        // load_ini_snapshot()
+        fs::path prefix_root;
+
+        {
+            profile_span span("parse inis");
+
+            if (!load_ini_snapshot(inis, prefix_root)) {
+                prefix_root = process_inis(inis);
+                save_ini_snapshot(inis, prefix_root);
+            }
+        }
+
+        if (prefix_root.empty())
+            prefix_root = fs::current_path();
+
         if (!opts.empty()) {
+            profile_span span("command line options");
+
             const fs::path prefix_before = conf().path().prefix();
 
             process_cmd_options(opts);
@@ -626,12 +1513,107 @@ namespace mob {
         // set up the log file, resolve against prefix if relative
         conf().set_log_file();
 
+        // all the options are known, task options can be resolved once instead
+        // of on every lookup; this is done before resolve_paths() because some of
+        // the lookups check whether tasks are enabled from other threads
+        {
+            profile_span span("freeze task options");
+            details::freeze_task_options();
+        }
+
         // goes through all paths and tools, finds missing or relative stuff, bails
-        // out of stuff can't be found
+        // out of stuff can't be found; the expensive lookups are cached in the
+        // prefix and run in the background
+        //
+        // qt's bin directory is not added to PATH, only to the environment of
+        // the tools that need it, see qt::with_bin_path()
+        profile_span span("resolve paths");
+        load_discovery_cache(inis, opts);
         resolve_paths();
+    }
+
+    std::chrono::nanoseconds bench_task_options(std::size_t iterations, bool frozen)
+    {
+        std::vector<std::string> keys;
+        for (auto&& [k, unused] : details::g_tasks[""])
+            keys.push_back(k);
+
+        const auto tasks = task_manager::instance().all();
+
+        // makes sure the lookups are not optimized away
+        std::size_t total = 0;
 
-        // make sure qt's bin directory is in the path
-        this_env::append_to_path(conf().path().get("qt_bin"));
+        const auto start = hr_clock::now();
+
+        for (std::size_t i = 0; i < iterations; ++i) {
+            for (const auto* t : tasks) {
+                if (frozen) {
+                    const auto tc = conf().task(t->names());
+
+                    total += tc.get<bool>("enabled");
+                    for (auto&& k : keys)
+                        total += tc.get(k).size();
+                }
+                else {
+                    total += details::get_bool_for_task(t->names(), "enabled");
+                    for (auto&& k : keys)
+                        total += details::get_string_for_task(t->names(), k).size();
+                }
+            }
+        }
+
+        const auto end = hr_clock::now();
+
+        static volatile std::size_t sink;
+        sink = total;
+
+        return end - start;
+    }
+
+    bench_options make_bench_options(std::size_t copies)
+    {
+        bench_options o;
+
+        for (std::size_t i = 0; i < copies; ++i) {
+            for (const auto* t : task_manager::instance().all()) {
+                const auto tc = conf().task(t->names());
+
+                o.ini += std::format("[{}:task]\n", t->name());
+
+                for (auto&& [k, unused] : details::g_tasks[""]) {
+                    const auto v = tc.get(k);
+
+                    o.ini += std::format("{} = {}\n", k, v);
+                    o.cmd.push_back(std::format("{}:task/{}={}", t->name(), k, v));
+                }
+
+                o.ini += "\n";
+            }
+        }
+
+        return o;
+    }
+
+    std::chrono::nanoseconds bench_process_ini(const fs::path& ini,
+                                               std::size_t iterations)
+    {
+        const auto start = hr_clock::now();
+
+        for (std::size_t i = 0; i < iterations; ++i)
+            process_ini(ini, false);
+
+        return hr_clock::now() - start;
+    }
+
+    std::chrono::nanoseconds bench_cmd_options(const std::vector<std::string>& opts,
+                                               std::size_t iterations)
+    {
+        const auto start = hr_clock::now();
+
+        for (std::size_t i = 0; i < iterations; ++i)
+            process_cmd_options(opts);
+
+        return hr_clock::now() - start;
     }
 
     bool verify_options()
@@ -672,6 +1654,11 @@ namespace mob {
         return {};
     }
 
+    conf_cache conf::cache()
+    {
+        return {};
+    }
+
     conf_tools conf::tool()
     {
         return {};
@@ -742,26 +1729,91 @@ namespace mob {
         return details::get_string(name(), "host");
     }
 
-    conf_task::conf_task(std::vector<std::string> names) : names_(std::move(names)) {}
+    bool conf_cmake::superbuild() const
+    {
+        return details::get_bool(name(), "superbuild");
+    }
+
+    conf_cache::conf_cache() : conf_section("cache") {}
+
+    fs::path conf_cache::launcher() const
+    {
+        return details::get_string(name(), "launcher");
+    }
+
+    fs::path conf_cache::directory() const
+    {
+        fs::path p = details::get_string(name(), "directory");
+
+        if (p.empty())
+            return conf().path().prefix() / "compiler_cache";
+        else if (p.is_relative())
+            return conf().path().prefix() / p;
+        else
+            return p;
+    }
+
+    conf_task::conf_task(std::vector<std::string> names)
+        : names_(std::move(names)), frozen_(details::frozen_task_options()),
+          task_(frozen_ ? details::find_frozen_task(*frozen_, names_) : nullptr)
+    {
+    }
 
     std::string conf_task::get(std::string_view key) const
     {
+        if (task_) {
+            if (const auto i = details::find_frozen_key(*frozen_, key))
+                return task_->values[*i];
+        }
+
         return details::get_string_for_task(names_, key);
     }
 
     bool conf_task::get_bool(std::string_view key) const
     {
+        if (task_) {
+            if (const auto i = details::find_frozen_key(*frozen_, key))
+                return task_->bools[*i];
+        }
+
         return details::get_bool_for_task(names_, key);
     }
 
     mob::config conf_task::configuration() const
     {
+        if (task_ && task_->configuration)
+            return *task_->configuration;
+
         return details::parse_cmake_value(
             names_[0], "configuration",
             details::get_string_for_task(names_, "configuration"),
             details::s_configuration_values);
     }
 
+    int conf_task::cmake_unity_batch() const
+    {
+        if (task_) {
+            const auto i = details::find_frozen_key(*frozen_, "cmake_unity_batch");
+            if (i && task_->ints[*i])
+                return *task_->ints[*i];
+        }
+
+        const auto s = get("cmake_unity_batch");
+
+        try {
+            return std::stoi(s);
+        }
+        catch (std::exception&) {
+            gcx().bail_out(context::conf, "bad int for {}/cmake_unity_batch",
+                           names_[0]);
+        }
+    }
+
+    std::vector<std::string> conf_task::cmake_pch() const
+    {
+        return split(get("cmake_pch"), " ");
+    }
+
     conf_tools::conf_tools() : conf_section("tools") {}
 
     conf_transifex::conf_transifex() : conf_section("transifex") {}
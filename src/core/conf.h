@@ -36,6 +36,11 @@ namespace mob::details {
     void set_string(std::string_view section, std::string_view key,
                     std::string_view value);
 
+    // resolved task options, see conf.cpp
+    //
+    struct frozen_task;
+    struct frozen_options;
+
 }  // namespace mob::details
 
 namespace mob {
@@ -55,6 +60,45 @@ namespace mob {
     //
     std::vector<std::string> format_options();
 
+    // waits for the paths and tools from init_options() that are still being
+    // looked up in the background, see resolve_paths(); must be called before
+    // exiting because the lookups use globals
+    //
+    void join_lookups();
+
+    // used by `mob bench`, resolves every task option for every task
+    // `iterations` times, either through conf_task, which uses the options
+    // frozen in init_options(), or by searching through all the
+    // options like before; returns the time it took
+    //
+    std::chrono::nanoseconds bench_task_options(std::size_t iterations, bool frozen);
+
+    // used by `mob bench ini`, generated options that override every task option
+    // for every task, `copies` times
+    //
+    struct bench_options {
+        // the overrides as `[task:task]` sections
+        std::string ini;
+
+        // the same overrides as `task:task/key=value` strings
+        std::vector<std::string> cmd;
+    };
+
+    // returns overrides that set every task option to its current value, so
+    // processing them doesn't change anything
+    //
+    bench_options make_bench_options(std::size_t copies);
+
+    // used by `mob bench ini`, processes the given ini the same way as the inis
+    // that are not the master, or the given command line options, `iterations`
+    // times; returns the time it took
+    //
+    std::chrono::nanoseconds bench_process_ini(const fs::path& ini,
+                                               std::size_t iterations);
+
+    std::chrono::nanoseconds bench_cmd_options(const std::vector<std::string>& opts,
+                                               std::size_t iterations);
+
     // base class for all conf structs
     //
     template <class DefaultType>
@@ -144,6 +188,27 @@ namespace mob {
         // an empty string means no host configured
         //
         std::string host() const;
+
+        // whether the ModOrganizer projects are built together as one cmake
+        // project by the superbuild task instead of one at a time
+        //
+        bool superbuild() const;
+    };
+
+    // options in [cache]
+    //
+    class conf_cache : public conf_section<std::string> {
+    public:
+        conf_cache();
+
+        // compiler launcher such as ccache or sccache, empty if disabled
+        //
+        fs::path launcher() const;
+
+        // directory where the launcher stores its cache, resolved against the
+        // prefix if relative; defaults to prefix/compiler_cache
+        //
+        fs::path directory() const;
     };
 
     // options in [task] or [task_name:task]
@@ -171,6 +236,11 @@ namespace mob {
         bool ignore_ts() const { return get<bool>("ignore_ts"); }
         std::string git_url_prefix() const { return get("git_url_prefix"); }
         bool git_shallow() const { return get<bool>("git_shallow"); }
+        bool git_maintenance() const { return get<bool>("git_maintenance"); }
+        std::string cmake_generator() const { return get("cmake_generator"); }
+        std::string cmake_preset() const { return get("cmake_preset"); }
+        bool cmake_unity_build() const { return get<bool>("cmake_unity_build"); }
+        bool cmake_benchmark() const { return get<bool>("cmake_benchmark"); }
         std::string git_user() const { return get("git_username"); }
         std::string git_email() const { return get("git_email"); }
         bool set_origin_remote() const { return get<bool>("set_origin_remote"); }
@@ -189,9 +259,26 @@ namespace mob {
         //
         mob::config configuration() const;
 
+        // CMAKE_UNITY_BUILD_BATCH_SIZE, 0 to use cmake's default
+        //
+        int cmake_unity_batch() const;
+
+        // headers to precompile for all targets, such as "<QtWidgets>"
+        //
+        std::vector<std::string> cmake_pch() const;
+
     private:
         std::vector<std::string> names_;
 
+        // options resolved at the end of init_options(), null before that; the
+        // table is immutable and kept alive by this pointer even if an option is
+        // set later on
+        std::shared_ptr<const details::frozen_options> frozen_;
+
+        // this task's options in frozen_, null if frozen_ is null or the task
+        // doesn't exist
+        const details::frozen_task* task_;
+
         bool get_bool(std::string_view name) const;
     };
 
@@ -281,6 +368,7 @@ namespace mob {
         conf_global global();
         conf_task task(const std::vector<std::string>& names);
         conf_cmake cmake();
+        conf_cache cache();
         conf_tools tool();
         conf_transifex transifex();
         conf_prebuilt prebuilt();
@@ -20,6 +20,9 @@ namespace mob {
     // global output mutex to avoid interleaving, but also mixing colors
     static std::mutex g_mutex;
 
+    // see context::capture_logs()
+    static thread_local context::captured_logs* t_captured_logs = nullptr;
+
     // returns the color associated with the given level
     //
     console_color level_color(context::level lv)
@@ -229,6 +232,17 @@ namespace mob {
         g_log_file.reset();
     }
 
+    void context::capture_logs(captured_logs* logs)
+    {
+        t_captured_logs = logs;
+    }
+
+    void context::emit_captured(const captured_logs& logs)
+    {
+        for (auto&& [lv, s] : logs)
+            global()->emit_log(lv, s);
+    }
+
     void context::log_string(reason r, level lv, std::string_view s) const
     {
         if (!enabled(lv))
@@ -256,6 +270,11 @@ namespace mob {
 
     void context::emit_log(level lv, std::string_view utf8) const
     {
+        if (t_captured_logs) {
+            t_captured_logs->emplace_back(lv, utf8);
+            return;
+        }
+
         std::scoped_lock lock(g_mutex);
 
         // console
@@ -99,6 +99,20 @@ namespace mob {
         //
         static void close_log_file();
 
+        // log lines kept by capture_logs()
+        //
+        using captured_logs = std::vector<std::pair<level, std::string>>;
+
+        // while `logs` is not null, everything logged on the current thread is
+        // appended to it instead of being written out; used by lookups running in
+        // the background so their output only shows up when something uses them
+        //
+        static void capture_logs(captured_logs* logs);
+
+        // writes out lines kept by capture_logs()
+        //
+        static void emit_captured(const captured_logs& logs);
+
         // creates a context for a task; the global context has no name
         //
         context(std::string task_name);
@@ -6,31 +6,161 @@
 #include "context.h"
 #include "op.h"
 #include "process.h"
+#include "profile.h"
 
 namespace mob {
 
-    // retrieves the Visual Studio environment variables for the given architecture;
-    // this is pretty expensive, so it's called on demand and only once, and is
-    // stored as a static variable in vs_x86() and vs_x64() below
+    // translates arch to the string needed by vcvars
     //
-    env get_vcvars_env(arch a)
+    std::string vcvars_arch(arch a)
     {
-        // translate arch to the string needed by vcvars
-        std::string arch_s;
-
         switch (a) {
         case arch::x86:
-            arch_s = "x86";
-            break;
+            return "x86";
 
         case arch::x64:
-            arch_s = "amd64";
-            break;
+            return "amd64";
 
         case arch::dont_care:
         default:
             gcx().bail_out(context::generic, "get_vcvars_env: bad arch");
         }
+    }
+
+    // parses the output of `set`, one `name=value` per line, and sets the
+    // variables in `e`
+    //
+    env parse_vcvars_output(std::istream& ss, env e)
+    {
+        gcx().trace(context::generic, "parsing variables");
+
+        for (;;) {
+            std::string line;
+            std::getline(ss, line);
+            if (!ss)
+                break;
+
+            const auto sep = line.find('=');
+
+            if (sep == std::string::npos)
+                continue;
+
+            std::string name  = line.substr(0, sep);
+            std::string value = line.substr(sep + 1);
+
+            gcx().trace(context::generic, "{} = {}", name, value);
+            e.set(std::move(name), std::move(value));
+        }
+
+        return e;
+    }
+
+    // the variables changed by vcvars are cached in the prefix for each
+    // architecture; they're only used if this key matches, which covers
+    // everything that can change what vcvars outputs
+    //
+    std::uint64_t vcvars_cache_key(const std::string& arch_s)
+    {
+        auto stamp = [](const fs::path& p) {
+            std::error_code ec;
+            const auto t = fs::last_write_time(p, ec);
+            return (ec ? "" : std::to_string(t.time_since_epoch().count()));
+        };
+
+        // older caches had the whole environment instead of only the changes
+        std::uint64_t h = fnv1a("changes");
+        h               = fnv1a(path_to_utf8(vs::vcvars()), h);
+        h               = fnv1a(arch_s, h);
+        h               = fnv1a(vs::version(), h);
+        h               = fnv1a(vs::sdk(), h);
+
+        // fingerprint of the installation: vcvars itself, the default toolset,
+        // and the toolsets and sdks that are installed, vcvars picks the latest
+        const auto vc = vs::installation_path() / "VC";
+        const auto tv =
+            vc / "Auxiliary" / "Build" / "Microsoft.VCToolsVersion.default.txt";
+
+        h = fnv1a(stamp(vs::vcvars()), h);
+        h = fnv1a(op::read_text_file(gcx(), encodings::utf8, tv, op::optional), h);
+        h = fnv1a(stamp(vc / "Tools" / "MSVC"), h);
+        h = fnv1a(stamp(conf().path().pf_x86() / "Windows Kits" / "10" / "Include"), h);
+
+        // vcvars adds to the environment it's started with, but only these
+        // variables change what it sets; anything else differs between terminals
+        // and would make the cache useless
+        auto used = [](const std::wstring& k) {
+            for (const wchar_t* name :
+                 {L"PATH", L"INCLUDE", L"LIB", L"LIBPATH", L"VCToolsVersion"}) {
+                if (_wcsicmp(k.c_str(), name) == 0)
+                    return true;
+            }
+
+            return (_wcsnicmp(k.c_str(), L"VSCMD_", 6) == 0 ||
+                    _wcsnicmp(k.c_str(), L"WindowsSdk", 10) == 0);
+        };
+
+        for (auto&& [k, v] : this_env::get().get_map()) {
+            if (used(k))
+                h = fnv1a(utf16_to_utf8(k + L"=" + v + L'\n'), h);
+        }
+
+        return h;
+    }
+
+    fs::path vcvars_cache_file(const std::string& arch_s)
+    {
+        return conf().path().prefix() / std::format("mob_vcvars_{}.cache", arch_s);
+    }
+
+    bool vcvars_cache_enabled()
+    {
+        return !conf().global().dry() && conf().global().get<bool>("discovery_cache");
+    }
+
+    // returns the cached vcvars environment for the given architecture if its
+    // key matches: mob's current environment with the cached variables on top
+    //
+    std::optional<env> load_vcvars_cache(arch a)
+    {
+        if (!vcvars_cache_enabled())
+            return {};
+
+        const auto arch_s = vcvars_arch(a);
+        const auto file   = vcvars_cache_file(arch_s);
+
+        profile_span span("vcvars cache " + arch_s);
+
+        if (!fs::exists(file))
+            return {};
+
+        std::stringstream ss(
+            op::read_text_file(gcx(), encodings::utf8, file, op::optional));
+
+        std::string key;
+        std::getline(ss, key);
+
+        if (key != std::format("key {:016x}", vcvars_cache_key(arch_s))) {
+            gcx().debug(context::generic, "vcvars cache {} is stale", file);
+            return {};
+        }
+
+        gcx().trace(context::generic, "using vcvars for {} from {}", arch_s, file);
+
+        return parse_vcvars_output(ss, this_env::get());
+    }
+
+    // retrieves the Visual Studio environment variables for the given architecture;
+    // this is pretty expensive, so it's called on demand and only once, and the
+    // result is cached on disk, see vcvars_env() below
+    //
+    env get_vcvars_env(arch a)
+    {
+        if (auto e = load_vcvars_cache(a))
+            return *e;
+
+        const std::string arch_s = vcvars_arch(a);
+
+        profile_span span("vcvars " + arch_s);
 
         gcx().trace(context::generic, "looking for vcvars for {}", arch_s);
 
@@ -56,45 +186,144 @@ namespace mob {
         gcx().trace(context::generic, "reading from {}", tmp);
 
         // reads the file, converting utf16 to utf8
-        std::stringstream ss(op::read_text_file(gcx(), encodings::utf16, tmp));
+        std::stringstream all(op::read_text_file(gcx(), encodings::utf16, tmp));
         op::delete_file(gcx(), tmp);
 
-        // `ss` contains all the variables in utf8
+        // `set` outputs the whole environment, but only the variables added or
+        // changed by vcvars are kept; everything else is taken from mob's
+        // environment when they're used, which might not be the same as now for
+        // variables like TEMP or proxies that are not part of the cache key
+        const auto input = this_env::get();
+        std::string vars;
 
-        env e;
+        for (auto&& [k, v] : parse_vcvars_output(all, env()).get_map()) {
+            const auto name  = utf16_to_utf8(k);
+            const auto value = utf16_to_utf8(v);
 
-        gcx().trace(context::generic, "parsing variables");
+            if (input.get(name) != value)
+                vars += name + "=" + value + "\n";
+        }
 
-        for (;;) {
-            std::string line;
-            std::getline(ss, line);
-            if (!ss)
-                break;
+        // the prefix might not exist yet, in which case the next run will write it
+        if (vcvars_cache_enabled() && fs::exists(conf().path().prefix())) {
+            op::write_text_file(
+                gcx(), encodings::utf8, vcvars_cache_file(arch_s),
+                std::format("key {:016x}\n{}", vcvars_cache_key(arch_s), vars),
+                op::optional);
+        }
 
-            const auto sep = line.find('=');
+        std::stringstream ss(vars);
+        return parse_vcvars_output(ss, input);
+    }
 
-            if (sep == std::string::npos)
-                continue;
+    // a vcvars lookup for one architecture, see vcvars_env()
+    //
+    struct vcvars_lookup {
+        std::shared_future<env> e;
 
-            std::string name  = line.substr(0, sep);
-            std::string value = line.substr(sep + 1);
+        // logs of a lookup that was started in advance, written out when it's
+        // needed so errors don't show up if it never is
+        std::shared_ptr<context::captured_logs> logs;
+    };
 
-            gcx().trace(context::generic, "{} = {}", name, value);
-            e.set(std::move(name), std::move(value));
+    static std::mutex g_vcvars_mutex;
+    static std::map<arch, vcvars_lookup> g_vcvars;
+
+    // lookup threads, joined in join_vcvars_lookups(); protected by
+    // g_vcvars_mutex
+    static std::vector<std::thread> g_vcvars_threads;
+
+    // returns the vcvars environment for the given architecture, computed once
+    //
+    // vcvars takes a few seconds for each architecture; when one isn't cached,
+    // the other one probably isn't either and will most likely be needed too,
+    // so both are started at the same time
+    //
+    env vcvars_env(arch a)
+    {
+        std::shared_future<env> f;
+
+        {
+            std::scoped_lock lock(g_vcvars_mutex);
+
+            if (!g_vcvars.contains(a)) {
+                if (auto e = load_vcvars_cache(a)) {
+                    std::promise<env> p;
+                    p.set_value(std::move(*e));
+                    g_vcvars[a].e = p.get_future().share();
+                }
+                else {
+                    for (arch other : {arch::x86, arch::x64}) {
+                        if (g_vcvars.contains(other))
+                            continue;
+
+                        std::shared_ptr<context::captured_logs> logs;
+                        if (other != a)
+                            logs = std::make_shared<context::captured_logs>();
+
+                        auto p = std::make_shared<std::promise<env>>();
+                        g_vcvars[other] = {p->get_future().share(), logs};
+
+                        g_vcvars_threads.push_back(start_thread([other, p, logs] {
+                            context::capture_logs(logs.get());
+
+                            try {
+                                p->set_value(get_vcvars_env(other));
+                            }
+                            catch (...) {
+                                p->set_exception(std::current_exception());
+                            }
+
+                            context::capture_logs(nullptr);
+                        }));
+                    }
+                }
+            }
+
+            f = g_vcvars[a].e;
         }
 
-        return e;
+        // only shows up in the profile if the lookup wasn't done yet
+        if (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            profile_span span("wait for vcvars " + vcvars_arch(a));
+            f.wait();
+        }
+
+        {
+            std::scoped_lock lock(g_vcvars_mutex);
+
+            auto& logs = g_vcvars[a].logs;
+            if (logs) {
+                context::emit_captured(*logs);
+                logs.reset();
+            }
+        }
+
+        return f.get();
+    }
+
+    void join_vcvars_lookups()
+    {
+        std::vector<std::thread> threads;
+
+        {
+            std::scoped_lock lock(g_vcvars_mutex);
+            threads.swap(g_vcvars_threads);
+        }
+
+        for (auto& t : threads)
+            t.join();
     }
 
     env env::vs_x86()
     {
-        static env e = get_vcvars_env(arch::x86);
+        static env e = vcvars_env(arch::x86);
         return e;
     }
 
     env env::vs_x64()
     {
-        static env e = get_vcvars_env(arch::x64);
+        static env e = vcvars_env(arch::x64);
         return e;
     }
 
@@ -115,34 +344,32 @@ namespace mob {
         }
     }
 
-    env::env() : own_(false)
+    env::env()
     {
-        // empty env, does not own
+        // empty env
     }
 
-    env::env(const env& e) : data_(e.data_), own_(false)
+    env::env(const env& e) : data_(e.data_)
     {
-        // copy data, does not own
+        // share data
     }
 
-    env::env(env&& e) : data_(std::move(e.data_)), own_(e.own_)
+    env::env(env&& e) : data_(std::move(e.data_))
     {
-        // move data, owns if `e` did
+        // take data
     }
 
     env& env::operator=(const env& e)
     {
-        // copy data, does not own
+        // share data
         data_ = e.data_;
-        own_  = false;
         return *this;
     }
 
     env& env::operator=(env&& e)
     {
-        // copy data, owns if `e` did
+        // take data
         data_ = std::move(e.data_);
-        own_  = e.own_;
         return *this;
     }
 
@@ -281,7 +508,6 @@ namespace mob {
         if (!data_)
             return {};
 
-        std::scoped_lock lock(data_->m);
         return data_->vars;
     }
 
@@ -291,14 +517,21 @@ namespace mob {
         // null and also terminated by a null, so there are two null characters at
         // the end
 
-        data_->sys.clear();
+        std::size_t size = 1;
+        for (auto&& v : data_->vars)
+            size += v.first.size() + v.second.size() + 2;
+
+        std::wstring& sys = data_->sys;
+        sys.reserve(size);
 
         for (auto&& v : data_->vars) {
-            data_->sys += v.first + L"=" + v.second;
-            data_->sys.append(1, L'\0');
+            sys.append(v.first);
+            sys.append(1, L'=');
+            sys.append(v.second);
+            sys.append(1, L'\0');
         }
 
-        data_->sys.append(1, L'\0');
+        sys.append(1, L'\0');
     }
 
     std::wstring* env::find(std::wstring_view name)
@@ -324,46 +557,29 @@ namespace mob {
         if (!data_ || data_->vars.empty())
             return nullptr;
 
-        // create string if it doesn't exist
-        {
-            std::scoped_lock lock(data_->m);
-            if (data_->sys.empty())
-                create_sys();
-        }
+        // create string if it doesn't exist; the data never changes once it's
+        // shared, so this is only done once for all the copies of this env
+        std::call_once(data_->sys_once, [&] {
+            create_sys();
+        });
 
         return (void*)data_->sys.c_str();
     }
 
     void env::copy_for_write()
     {
-        if (own_) {
-            // this is called every time something is about to change; if this
-            // instance already owns the data, the sys strings must still be cleared
-            // out so they're recreated if get_unicode_pointers() is every called
-            if (data_)
-                data_->sys.clear();
-
+        // if this is the only instance with this data, nobody else can be
+        // looking at it and it can be changed in place, unless the unicode
+        // strings were already created, since they'd be out of date
+        if (data_ && data_.use_count() == 1 && data_->sys.empty())
             return;
-        }
 
-        if (data_) {
-            // remember the shared data
-            auto shared = data_;
+        auto d = std::make_shared<data>();
 
-            // create a new owned instance
-            data_.reset(new data);
-
-            // copying
-            std::scoped_lock lock(shared->m);
-            data_->vars = shared->vars;
-        }
-        else {
-            // creating own, empty data
-            data_.reset(new data);
-        }
+        if (data_)
+            d->vars = data_->vars;
 
-        // this instance owns the data
-        own_ = true;
+        data_ = std::move(d);
     }
 
     // mob's environment variables are only retrieved once and are kept in sync
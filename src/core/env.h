@@ -4,7 +4,12 @@
 
 namespace mob {
 
-    // a set of environment variables; copy-on-write because this gets copied a lot
+    // a set of environment variables; this gets copied a lot, so the variables
+    // are shared between copies and never modified once they're shared, changing
+    // a shared env makes a new copy of the variables first
+    //
+    // this also allows the block given to CreateProcess() to be created once
+    // and reused by every process that gets a copy of the same env
     //
     class env {
     public:
@@ -62,28 +67,25 @@ namespace mob {
         map get_map() const;
 
         // passed to CreateProcess() in the process class; returns a pointer to a
-        // block of utf16 strings, owned by this, created on demand
+        // block of utf16 strings, created the first time it's needed and shared
+        // by all the copies of this env
         //
         void* get_unicode_pointers() const;
 
     private:
-        // shared between copies
+        // shared between copies, immutable once shared
         //
         struct data {
-            std::mutex m;
             map vars;
 
             // unicode strings, see get_unicode_pointers()
+            mutable std::once_flag sys_once;
             mutable std::wstring sys;
         };
 
-        // shared data
+        // shared data, null for an empty env
         std::shared_ptr<data> data_;
 
-        // whether this instance owns the data, set to true in copy_for_write()
-        // when the data must be modified
-        bool own_;
-
         // creates the unicode strings
         //
         void create_sys() const;
@@ -97,7 +99,9 @@ namespace mob {
         //
         void set_impl(std::wstring k, std::wstring v, flags f);
 
-        // duplicates the data, sets own_=true
+        // called before changing anything; makes a new copy of the data if it's
+        // shared with another env or if its unicode strings have already been
+        // created
         //
         void copy_for_write();
 
@@ -138,4 +142,10 @@ namespace mob {
         static std::optional<std::wstring> get_impl(const std::string& k);
     };
 
+    // waits for the vcvars lookups started by env::vs() that are still running,
+    // see vcvars_env() in env.cpp; must be called before exiting because the
+    // lookups use globals
+    //
+    void join_vcvars_lookups();
+
 }  // namespace mob
@@ -231,6 +231,11 @@ namespace mob {
         return "\"" + path_to_utf8(exec_.bin) + "\"" + exec_.cmd;
     }
 
+    std::string process::command_line() const
+    {
+        return make_cmd();
+    }
+
     void process::pipe_into(const process& p)
     {
         exec_.raw = make_cmd() + " | " + p.make_cmd();
@@ -172,6 +172,11 @@ namespace mob {
         process& binary(const fs::path& p);
         const fs::path& binary() const;
 
+        // the full command line that will be given to cmd, including the binary
+        // and all the arguments
+        //
+        std::string command_line() const;
+
         // working directory
         //
         process& cwd(const fs::path& p);
@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "profile.h"
+#include "context.h"
+
+namespace mob {
+
+    struct recorded_span {
+        std::string name;
+        std::chrono::nanoseconds start, end;
+        DWORD tid;
+    };
+
+    // spans can be recorded from any thread, such as the lookups started by
+    // resolve_paths()
+    static std::mutex g_spans_mutex;
+    static std::vector<recorded_span> g_spans;
+
+    // set in enable_profile()
+    static fs::path g_trace;
+
+    profile_span::profile_span(std::string name)
+        : name_(std::move(name)), start_(timestamp())
+    {
+    }
+
+    profile_span::~profile_span()
+    {
+        record_profile_span(std::move(name_), start_, timestamp());
+    }
+
+    void record_profile_span(std::string name, std::chrono::nanoseconds start,
+                             std::chrono::nanoseconds end)
+    {
+        std::scoped_lock lock(g_spans_mutex);
+        g_spans.push_back({std::move(name), start, end, GetCurrentThreadId()});
+    }
+
+    void enable_profile(fs::path trace)
+    {
+        std::scoped_lock lock(g_spans_mutex);
+        g_trace = std::move(trace);
+    }
+
+    void profile_report()
+    {
+        std::vector<recorded_span> spans;
+        fs::path trace;
+
+        {
+            std::scoped_lock lock(g_spans_mutex);
+
+            if (g_trace.empty())
+                return;
+
+            spans = g_spans;
+            trace = g_trace;
+        }
+
+        auto ms = [](std::chrono::nanoseconds d) {
+            return static_cast<double>(d.count()) / 1'000'000.0;
+        };
+
+        // threads are shown as small numbers in the order they appear, the main
+        // thread is always first because it records the first span
+        std::map<DWORD, std::size_t> threads;
+        for (auto&& s : spans)
+            threads.emplace(s.tid, threads.size());
+
+        // the trace has the spans in the order they started, which is what the
+        // viewers expect
+        std::sort(spans.begin(), spans.end(), [](auto&& a, auto&& b) {
+            return (a.start < b.start);
+        });
+
+        nlohmann::json events = nlohmann::json::array();
+
+        for (auto&& s : spans) {
+            // trace timestamps are in microseconds
+            events.push_back({{"name", s.name},
+                              {"ph", "X"},
+                              {"ts", s.start.count() / 1000},
+                              {"dur", (s.end - s.start).count() / 1000},
+                              {"pid", GetCurrentProcessId()},
+                              {"tid", threads[s.tid]}});
+        }
+
+        // spans are nested, so the breakdown is sorted by duration, which puts
+        // the outer spans first
+        std::stable_sort(spans.begin(), spans.end(), [](auto&& a, auto&& b) {
+            return ((a.end - a.start) > (b.end - b.start));
+        });
+
+        u8cout << "startup profile, in ms:\n"
+               << std::format("  {:>10} {:>10} {:>6}  {}\n", "duration", "start",
+                              "thread", "span");
+
+        for (auto&& s : spans) {
+            u8cout << std::format("  {:>10.1f} {:>10.1f} {:>6}  {}\n",
+                                  ms(s.end - s.start), ms(s.start), threads[s.tid],
+                                  s.name);
+        }
+
+        const nlohmann::json j = {{"traceEvents", events},
+                                  {"displayTimeUnit", "ms"}};
+
+        // not using op::write_text_file() because it does nothing with --dry
+        std::ofstream out(trace, std::ios::binary);
+        out << j.dump(2);
+
+        if (!out) {
+            u8cerr << "failed to write trace to " << path_to_utf8(trace) << "\n";
+            return;
+        }
+
+        u8cout << "trace written to " << path_to_utf8(trace) << "\n";
+    }
+
+}  // namespace mob
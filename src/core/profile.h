@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../utility.h"
+
+namespace mob {
+
+    // records how long something took for `--profile-startup`, from construction
+    // to destruction
+    //
+    // spans are always recorded because some of them happen before the command
+    // line is parsed, but they're only reported if enable_profile() was called;
+    // they're meant for coarse things like parsing the inis or running vcvars,
+    // not for anything called in a loop
+    //
+    class profile_span {
+    public:
+        explicit profile_span(std::string name);
+        ~profile_span();
+
+        profile_span(const profile_span&)            = delete;
+        profile_span& operator=(const profile_span&) = delete;
+
+    private:
+        std::string name_;
+        std::chrono::nanoseconds start_;
+    };
+
+    // records a span that's already over, `start` and `end` are from timestamp()
+    //
+    void record_profile_span(std::string name, std::chrono::nanoseconds start,
+                             std::chrono::nanoseconds end);
+
+    // profile_report() will output the spans and write them to `trace` in the
+    // chrome trace event format, which can be opened in chrome://tracing or
+    // https://ui.perfetto.dev
+    //
+    void enable_profile(fs::path trace);
+
+    // outputs all the spans recorded until now sorted by duration and writes the
+    // trace file; does nothing if enable_profile() wasn't called
+    //
+    // spans that haven't ended, such as lookups that were never needed and are
+    // still running in the background, are not included
+    //
+    void profile_report();
+
+}  // namespace mob
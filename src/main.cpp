@@ -1,7 +1,9 @@
 #include "pch.h"
 #include "cmd/commands.h"
 #include "core/conf.h"
+#include "core/env.h"
 #include "core/op.h"
+#include "core/profile.h"
 #include "net.h"
 #include "tasks/task_manager.h"
 #include "tasks/tasks.h"
@@ -76,6 +78,10 @@ namespace mob {
             .add_task<mo>({"modorganizer-preview_dds", "ddspreview"})
             .add_task<mo>({"modorganizer", "organizer"});
 
+        // builds all the projects above at once when [cmake] superbuild is set,
+        // does nothing otherwise
+        add_task<superbuild>();
+
         // other tasks
         add_task<translations>();
         add_task<installer>();
@@ -100,7 +106,8 @@ namespace mob {
             std::make_unique<git_command>(),
             std::make_unique<inis_command>(),
             std::make_unique<tx_command>(),
-            std::make_unique<cmake_config_command>()};
+            std::make_unique<cmake_config_command>(),
+            std::make_unique<bench_command>()};
 
         // commands are shown in the help
         help->set_commands(commands);
@@ -150,9 +157,18 @@ namespace mob {
         curl_init curl;
 
         try {
-            add_tasks();
+            {
+                profile_span span("register tasks");
+                add_tasks();
+            }
+
+            std::shared_ptr<command> c;
+
+            {
+                profile_span span("command line");
+                c = handle_command_line(args);
+            }
 
-            auto c = handle_command_line(args);
             if (!c)
                 return 1;
 
@@ -179,6 +195,13 @@ int wmain(int argc, wchar_t** argv)
         args.push_back(mob::utf16_to_utf8(argv[i]));
 
     int r = mob::run(args);
+
+    // some of the paths and vcvars might still be looked up in the background if
+    // nothing needed them, they use globals that are destroyed after returning
+    mob::join_lookups();
+    mob::join_vcvars_lookups();
+
+    mob::profile_report();
     mob::dump_logs();
 
     return r;
@@ -44,6 +44,7 @@
 #pragma warning(disable : 4244)  // possible loss of data
 #pragma warning(disable : 4275)  // non dll-interface base
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <charconv>
@@ -51,6 +52,7 @@
 #include <format>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <map>
 #include <mutex>
@@ -60,6 +62,7 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <Shlobj.h>
@@ -125,7 +125,7 @@ namespace mob::tasks {
 
         // cmake clean
         if (is_set(c, clean::reconfigure))
-            run_tool(cmake(cmake::clean).root(source_path()));
+            run_tool(cmake(cmake::clean).generator(generator()).root(source_path()));
     }
 
     void modorganizer::do_fetch()
@@ -159,6 +159,29 @@ namespace mob::tasks {
                           .submodule(name())
                           .root(super_path())));
 
+        build();
+
+        // the superbuild task queues it once everything is built
+        const bool superbuild = conf().cmake().superbuild() &&
+                                exists(source_path() / "CMakeLists.txt");
+
+        if (!superbuild)
+            queue_git_maintenance();
+    }
+
+    void modorganizer::queue_git_maintenance() const
+    {
+        // optimizes the repo once it's built so it doesn't compete with the fetch
+        // or the build of this project; it only runs when nothing is building,
+        // or after all the tasks are done
+        if (!task_conf().git_maintenance())
+            return;
+
+        git_submodule_adder::instance().queue(git_maintenance().root(source_path()));
+    }
+
+    void modorganizer::build()
+    {
         // not all modorganizer projects need to actually be built, such as
         // cmake_common, so don't try if there's no cmake file
         if (!exists(source_path() / "CMakeLists.txt")) {
@@ -175,30 +198,116 @@ namespace mob::tasks {
                            "{} has no CMakePresets.txt, aborting build", repo_);
         }
 
+        // the superbuild task will build everything at once when the sources
+        // for all the projects are available
+        if (conf().cmake().superbuild()) {
+            cx().trace(context::generic, "{} will be built by the superbuild task",
+                       repo_);
+
+            return;
+        }
+
+        if (task_conf().cmake_benchmark()) {
+            benchmark();
+            return;
+        }
+
+        generate_and_build(true, true);
+    }
+
+    void modorganizer::generate_and_build(bool tuning, bool cache)
+    {
+        // unity builds and precompiled headers from the ini, or turned off
+        const bool unity = tuning && task_conf().cmake_unity_build();
+
+        std::vector<std::string> pch;
+        if (tuning)
+            pch = task_conf().cmake_pch();
+
+        auto generate = cmake(cmake::generate)
+                            .generator(generator())
+                            .compiler_cache(cache)
+                            .unity_build(unity, task_conf().cmake_unity_batch())
+                            .precompiled_headers(pch)
+                            .def("CMAKE_INSTALL_PREFIX:PATH", conf().path().install())
+                            .def("CMAKE_PREFIX_PATH", cmake_prefix_path())
+                            .configuration_types({task_conf().configuration()})
+                            .preset(preset())
+                            .root(source_path());
+
+        // without a preset, its cache variables are still needed, like the vcpkg
+        // triplet and manifest features
+        if (preset().empty())
+            generate.cache_variables_from(configure_preset());
+
+        // the preset normally sets this, see preset()
+        const auto vcpkg_toolchain =
+            conf().path().vcpkg() / "scripts" / "buildsystems" / "vcpkg.cmake";
+
+        if (preset().empty() && exists(vcpkg_toolchain))
+            generate.def("CMAKE_TOOLCHAIN_FILE", vcpkg_toolchain);
+
         // run cmake
-        run_tool(cmake(cmake::generate)
-                     .generator(cmake::vs)
-                     .def("CMAKE_INSTALL_PREFIX:PATH", conf().path().install())
-                     .def("CMAKE_PREFIX_PATH", cmake_prefix_path())
-                     .configuration_types({task_conf().configuration()})
-                     .preset("vs2022-windows")
-                     .root(source_path()));
-
-        // run cmake --build with default target
+        run_tool(generate);
+
+        // run cmake --build on the install target, which depends on the default
+        // target in both visual studio and ninja, so everything is built and
+        // installed by a single build driver instead of going through all the
+        // projects twice; the `--parallel` value is a share of the global cpu
+        // pool, see cpu_pool
         // TODO: handle rebuild by adding `--clean-first`
-        // TODO: have a way to specify the `--parallel` value - 16 is useful to build
-        // game_bethesda that has 15 games, so 15 projects
         run_tool(cmake(cmake::build)
+                     .generator(generator())
+                     .compiler_cache(cache)
                      .root(source_path())
-                     .arg("--parallel")
-                     .arg("16")
+                     .targets(cmake::install_target(generator()))
                      .configuration(task_conf().configuration()));
+    }
 
-        // run cmake --install
-        run_tool(cmake(cmake::build)
-                     .root(source_path())
-                     .targets("INSTALL")
-                     .configuration(task_conf().configuration()));
+    void modorganizer::benchmark()
+    {
+        // both builds start from an empty build directory and don't use the
+        // compiler cache, which would make the second one meaningless
+        auto timed_build = [&](bool tuning) {
+            run_tool(cmake(cmake::clean).generator(generator()).root(source_path()));
+
+            const auto start = hr_clock::now();
+            generate_and_build(tuning, false);
+
+            return std::chrono::duration<double>(hr_clock::now() - start).count();
+        };
+
+        const auto without = timed_build(false);
+        const auto with    = timed_build(true);
+
+        cx().info(context::generic,
+                  "benchmark: {:.1f}s without unity builds and precompiled "
+                  "headers, {:.1f}s with them ({:+.0f}%)",
+                  without, with, ((with - without) * 100) / without);
+    }
+
+    cmake::generators modorganizer::generator() const
+    {
+        return cmake::parse_generator(task_conf().cmake_generator());
+    }
+
+    std::string modorganizer::configure_preset() const
+    {
+        const auto p = task_conf().cmake_preset();
+        if (!p.empty())
+            return p;
+
+        return "vs2022-windows";
+    }
+
+    std::string modorganizer::preset() const
+    {
+        // the presets from cmake_common are all for visual studio and force an
+        // architecture, which ninja doesn't support, so don't use one at all
+        if (generator() == cmake::ninja && task_conf().cmake_preset().empty())
+            return {};
+
+        return configure_preset();
     }
 
 }  // namespace mob::tasks
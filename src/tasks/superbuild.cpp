@@ -0,0 +1,364 @@
+#include "pch.h"
+#include "tasks.h"
+#include "task_manager.h"
+
+namespace mob::tasks {
+
+    // the superbuild generates a CMakeLists.txt in modorganizer_super that adds
+    // every enabled ModOrganizer project with add_subdirectory(), in the same
+    // order as the tasks in add_tasks(), and builds the install target once
+    //
+    // this gives the build tool one graph for all the projects, so plugins can
+    // start compiling while uibase is still linking, instead of each task
+    // waiting for the previous one to be fully built and installed
+    //
+    // the projects look for their dependencies with find_package(mo2-name),
+    // which would find the packages installed by a previous build, if any,
+    // instead of the targets in the same graph; after each add_subdirectory(),
+    // mob_redirect_package() points mo2-name_DIR to a stub config so the
+    // projects added after it use the mo2::name target directly
+    //
+    // the projects are not generated with their presets, the cache variables
+    // of the presets are given to the superproject instead, and their vcpkg
+    // manifests are merged into one, see write_vcpkg_manifest()
+    //
+    // all the projects share a single cmake scope for target names, projects
+    // that define targets with the same name can't be built this way
+
+    namespace {
+
+        // returns all the enabled modorganizer tasks, in the order they were
+        // added
+        //
+        std::vector<const modorganizer*> enabled_projects()
+        {
+            std::vector<const modorganizer*> v;
+
+            for (auto* t : task_manager::instance().all()) {
+                auto* mo = dynamic_cast<const modorganizer*>(t);
+                if (mo && mo->enabled())
+                    v.push_back(mo);
+            }
+
+            return v;
+        }
+
+    }  // namespace
+
+    superbuild::superbuild() : task("superbuild") {}
+
+    bool superbuild::enabled() const
+    {
+        if (!conf().cmake().superbuild() || !task::enabled())
+            return false;
+
+        return !enabled_projects().empty();
+    }
+
+    cmake::generators superbuild::generator() const
+    {
+        return cmake::parse_generator(task_conf().cmake_generator());
+    }
+
+    void superbuild::do_clean(clean c)
+    {
+        // cmake clean
+        if (is_set(c, clean::reconfigure)) {
+            run_tool(cmake(cmake::clean)
+                         .generator(generator())
+                         .root(modorganizer::super_path()));
+        }
+    }
+
+    void superbuild::do_build_and_install()
+    {
+        // projects without a CMakeLists.txt, like cmake_common, are not built
+        std::vector<const modorganizer*> projects;
+
+        for (auto* mo : enabled_projects()) {
+            if (exists(mo->source_path() / "CMakeLists.txt"))
+                projects.push_back(mo);
+        }
+
+        if (projects.empty()) {
+            cx().debug(context::generic, "no projects to build");
+            return;
+        }
+
+        write_cmakelists(projects);
+        write_vcpkg_manifest(projects);
+
+        const auto vcpkg_toolchain =
+            conf().path().vcpkg() / "scripts" / "buildsystems" / "vcpkg.cmake";
+
+        auto generate = cmake(cmake::generate)
+                            .generator(generator())
+                            .compiler_cache(true)
+                            .def("CMAKE_INSTALL_PREFIX:PATH", conf().path().install())
+                            .def("CMAKE_PREFIX_PATH", modorganizer::cmake_prefix_path())
+                            .def("MO2_SUPERBUILD:BOOL", "ON")
+                            .configuration_types({task_conf().configuration()})
+                            .root(modorganizer::super_path());
+
+        // the presets of the individual projects can't be used for the
+        // superproject, give their cache variables instead
+        bool toolchain = false;
+
+        for (auto&& [k, v] : cache_variables(projects)) {
+            generate.def(k, "\"" + v + "\"");
+
+            if (k == "CMAKE_TOOLCHAIN_FILE" || k.starts_with("CMAKE_TOOLCHAIN_FILE:"))
+                toolchain = true;
+        }
+
+        if (!toolchain && exists(vcpkg_toolchain))
+            generate.def("CMAKE_TOOLCHAIN_FILE", vcpkg_toolchain);
+
+        run_tool(generate);
+
+        // one build of the install target for everything, the `--parallel` value
+        // is a share of the global cpu pool, see cpu_pool
+        run_tool(cmake(cmake::build)
+                     .generator(generator())
+                     .compiler_cache(true)
+                     .root(modorganizer::super_path())
+                     .targets(cmake::install_target(generator()))
+                     .configuration(task_conf().configuration()));
+
+        for (auto* mo : projects)
+            mo->queue_git_maintenance();
+    }
+
+    void superbuild::write_cmakelists(
+        const std::vector<const modorganizer*>& projects)
+    {
+        std::string s;
+
+        s += "# generated by mob for the superbuild option in [cmake], any change\n"
+             "# will be overwritten\n"
+             "cmake_minimum_required(VERSION 3.16)\n"
+             "project(modorganizer_super)\n"
+             "\n"
+             "set(MO2_SUPERBUILD ON)\n"
+             "\n"
+             "# makes find_package(mo2-name) in the projects added after this one\n"
+             "# use the mo2::name target built here instead of an installed package;\n"
+             "# both mo2-some_name and mo2-some-name are redirected\n"
+             "function(mob_redirect_package name)\n"
+             "    if(NOT TARGET mo2::${name})\n"
+             "        if(NOT TARGET ${name})\n"
+             "            return()\n"
+             "        endif()\n"
+             "\n"
+             "        add_library(mo2::${name} ALIAS ${name})\n"
+             "    endif()\n"
+             "\n"
+             "    string(REPLACE \"_\" \"-\" dashed ${name})\n"
+             "\n"
+             "    foreach(package mo2-${name} mo2-${dashed})\n"
+             "        set(dir \"${CMAKE_BINARY_DIR}/mob_packages/${package}\")\n"
+             "\n"
+             "        file(WRITE \"${dir}/${package}-config.cmake\"\n"
+             "            \"# generated by mob, mo2::${name} is built by the "
+             "superbuild\\n\")\n"
+             "\n"
+             "        file(WRITE \"${dir}/${package}-config-version.cmake\"\n"
+             "            \"set(PACKAGE_VERSION "
+             "\\\"\\${PACKAGE_FIND_VERSION}\\\")\\n\"\n"
+             "            \"set(PACKAGE_VERSION_COMPATIBLE TRUE)\\n\")\n"
+             "\n"
+             "        set(${package}_DIR \"${dir}\" CACHE PATH \"\" FORCE)\n"
+             "    endforeach()\n"
+             "endfunction()\n"
+             "\n";
+
+        // projects are in the same order as the tasks, so dependencies are added
+        // before the projects that use them
+        for (auto* mo : projects) {
+            s += "add_subdirectory(" + mo->name() + ")\n";
+            s += "mob_redirect_package(" + mo->name() + ")\n";
+        }
+
+        write_if_changed(modorganizer::super_path() / "CMakeLists.txt", s);
+    }
+
+    void superbuild::write_vcpkg_manifest(
+        const std::vector<const modorganizer*>& projects)
+    {
+        // adds the dependency `d` to `list` unless there's already one with the
+        // same name, in which case their features are merged
+        auto add_dependency = [](nlohmann::json& list, const nlohmann::json& d) {
+            auto name_of = [](const nlohmann::json& j) {
+                return j.is_string() ? j.get<std::string>() : j.value("name", "");
+            };
+
+            for (auto& e : list) {
+                if (name_of(e) != name_of(d))
+                    continue;
+
+                if (d.is_object()) {
+                    if (e.is_string()) {
+                        e = d;
+                    }
+                    else {
+                        for (auto&& f : d.value("features", nlohmann::json::array())) {
+                            auto& fs = e["features"];
+                            if (std::find(fs.begin(), fs.end(), f) == fs.end())
+                                fs.push_back(f);
+                        }
+                    }
+                }
+
+                return;
+            }
+
+            list.push_back(d);
+        };
+
+        nlohmann::json manifest = {{"dependencies", nlohmann::json::array()}};
+        std::string configuration;
+        bool found = false;
+
+        for (auto* mo : projects) {
+            const auto file = mo->source_path() / "vcpkg.json";
+            if (!exists(file))
+                continue;
+
+            const auto json = nlohmann::json::parse(
+                op::read_text_file(cx(), encodings::utf8, file), nullptr, false);
+
+            if (json.is_discarded()) {
+                cx().warning(context::generic, "can't parse {}, ignoring it", file);
+                continue;
+            }
+
+            found = true;
+
+            for (auto&& d : json.value("dependencies", nlohmann::json::array()))
+                add_dependency(manifest["dependencies"], d);
+
+            for (auto&& [name, f] :
+                 json.value("features", nlohmann::json::object()).items()) {
+                auto& mf = manifest["features"][name];
+
+                if (!mf.contains("description"))
+                    mf["description"] = f.value("description", name);
+
+                if (!mf.contains("dependencies"))
+                    mf["dependencies"] = nlohmann::json::array();
+
+                for (auto&& d : f.value("dependencies", nlohmann::json::array()))
+                    add_dependency(mf["dependencies"], d);
+            }
+
+            // these must be the same for every project, the first one wins
+            for (auto&& key :
+                 {"builtin-baseline", "overrides", "vcpkg-configuration"}) {
+                if (!json.contains(key))
+                    continue;
+
+                if (!manifest.contains(key)) {
+                    manifest[key] = json[key];
+                }
+                else if (manifest[key] != json[key]) {
+                    cx().warning(context::generic,
+                                 "{} in {} is different from another project, "
+                                 "ignoring it",
+                                 key, file);
+                }
+            }
+
+            const auto conf_file = mo->source_path() / "vcpkg-configuration.json";
+
+            if (exists(conf_file)) {
+                const auto s =
+                    op::read_text_file(cx(), encodings::utf8, conf_file, op::optional);
+
+                if (configuration.empty()) {
+                    configuration = s;
+                }
+                else if (configuration != s) {
+                    cx().warning(context::generic,
+                                 "{} is different from another project, ignoring it",
+                                 conf_file);
+                }
+            }
+        }
+
+        if (!found)
+            return;
+
+        write_if_changed(modorganizer::super_path() / "vcpkg.json",
+                         manifest.dump(2) + "\n");
+
+        if (!configuration.empty()) {
+            write_if_changed(modorganizer::super_path() / "vcpkg-configuration.json",
+                             configuration);
+        }
+    }
+
+    std::map<std::string, std::string>
+    superbuild::cache_variables(const std::vector<const modorganizer*>& projects)
+    {
+        // set by mob for the superproject
+        const std::set<std::string> ignored = {
+            "CMAKE_INSTALL_PREFIX", "CMAKE_PREFIX_PATH", "CMAKE_BUILD_TYPE",
+            "CMAKE_CONFIGURATION_TYPES"};
+
+        std::map<std::string, std::string> vars;
+
+        for (auto* mo : projects) {
+            const auto preset_vars = cmake::preset_cache_variables(
+                mo->source_path(), mo->configure_preset());
+
+            for (auto&& [k, v] : preset_vars) {
+                const auto name = k.substr(0, k.find(':'));
+                if (ignored.contains(name))
+                    continue;
+
+                auto itor = vars.find(k);
+
+                if (itor == vars.end()) {
+                    vars.emplace(k, v);
+                }
+                else if (name == "VCPKG_MANIFEST_FEATURES") {
+                    // the manifest is shared, so are the features
+                    auto features = split(itor->second, ";");
+
+                    for (auto&& f : split(v, ";")) {
+                        if (std::find(features.begin(), features.end(), f) ==
+                            features.end()) {
+                            features.push_back(f);
+                        }
+                    }
+
+                    itor->second = join(features, ";");
+                }
+                else if (itor->second != v) {
+                    cx().warning(context::generic,
+                                 "{} is '{}' in the preset of {}, but '{}' in the "
+                                 "preset of another project, using the latter",
+                                 k, v, mo->name(), itor->second);
+                }
+            }
+        }
+
+        return vars;
+    }
+
+    void superbuild::write_if_changed(const fs::path& file, const std::string& s)
+    {
+        if (exists(file)) {
+            const auto current =
+                op::read_text_file(cx(), encodings::utf8, file, op::optional);
+
+            if (current == s) {
+                cx().trace(context::generic, "{} is up to date", file);
+                return;
+            }
+        }
+
+        op::write_text_file(cx(), encodings::utf8, file, s);
+    }
+
+}  // namespace mob::tasks
@@ -272,6 +272,9 @@ namespace mob {
         for (auto&& [name, f] : v) {
             cx().trace(context::generic, "running in parallel: {}", name);
 
+            // no token from the cpu pool is held here, the functions typically
+            // run tools that acquire their own and would wait for the ones held
+            // by the functions themselves
             tp.add([this, name, f] {
                 running_from_thread(name, f);
             });
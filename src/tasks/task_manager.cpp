@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "task_manager.h"
 #include "../core/context.h"
+#include "../tools/tools.h"
 #include "task.h"
 
 namespace mob {
@@ -20,7 +21,14 @@ namespace mob {
 
     void task_manager::register_task(task* t)
     {
+        std::scoped_lock lock(index_mutex_);
+
         all_.push_back(t);
+
+        // tasks are all registered before anything is looked up, but this might
+        // change
+        indexed_ = false;
+        globs_.clear();
     }
 
     std::vector<task*> task_manager::find(std::string_view pattern)
@@ -105,6 +113,9 @@ namespace mob {
         for (auto&& t : top_level_) {
             t->check_bailed();
         }
+
+        // the maintenance that didn't have a chance to run while building
+        git_submodule_adder::instance().finish_maintenance();
     }
 
     void task_manager::interrupt_all()
@@ -121,16 +132,114 @@ namespace mob {
 
     std::vector<task*> task_manager::find_by_pattern(std::string_view pattern)
     {
-        std::vector<task*> tasks;
+        // this used to call task::name_matches() on every task, which compiles a
+        // regex for every task when the pattern is a glob, and is called for
+        // every task section in the inis, every task option on the command line
+        // and every pattern of an alias
+
+        std::scoped_lock lock(index_mutex_);
+        build_index();
+
+        if (pattern.find('*') == std::string::npos) {
+            auto itor = names_.find(normalize_name(pattern));
+            if (itor == names_.end())
+                return {};
+
+            return itor->second;
+        }
+
+        std::string key(pattern);
+
+        auto itor = globs_.find(key);
+        if (itor != globs_.end())
+            return itor->second;
+
+        auto tasks = match_glob(pattern);
+        globs_.emplace(std::move(key), tasks);
+
+        return tasks;
+    }
+
+    void task_manager::build_index()
+    {
+        if (indexed_)
+            return;
+
+        names_.clear();
+        normalized_.clear();
+        normalized_.reserve(all_.size());
 
         for (auto&& t : all_) {
-            if (t->name_matches(pattern))
-                tasks.push_back(t);
+            std::vector<std::string> names;
+
+            for (auto&& n : t->names()) {
+                auto nn = normalize_name(n);
+
+                // a task can have names that only differ by case or underscores,
+                // it must only be returned once
+                if (std::find(names.begin(), names.end(), nn) != names.end())
+                    continue;
+
+                names_[nn].push_back(t);
+                names.push_back(std::move(nn));
+            }
+
+            normalized_.emplace_back(t, std::move(names));
+        }
+
+        indexed_ = true;
+    }
+
+    std::vector<task*> task_manager::match_glob(std::string_view pattern) const
+    {
+        std::regex re;
+
+        try {
+            // converts '*' to '.*', changes underscores to dashes so they're
+            // equivalent, then matches the pattern as a regex, case insensitive,
+            // same as task::name_matches_glob()
+            std::string fixed_pattern(pattern);
+            fixed_pattern = replace_all(fixed_pattern, "*", ".*");
+            fixed_pattern = replace_all(fixed_pattern, "_", "-");
+
+            re = std::regex(fixed_pattern, std::regex::icase | std::regex::optimize);
+        }
+        catch (std::exception&) {
+            u8cerr << "bad glob '" << pattern << "'\n"
+                   << "globs are actually bastardized regexes where '*' is "
+                   << "replaced by '.*', so don't push it\n";
+
+            throw bailed();
+        }
+
+        std::vector<task*> tasks;
+
+        for (auto&& [t, names] : normalized_) {
+            for (auto&& n : names) {
+                if (std::regex_match(n, re)) {
+                    tasks.push_back(t);
+                    break;
+                }
+            }
         }
 
         return tasks;
     }
 
+    std::string task_manager::normalize_name(std::string_view name)
+    {
+        std::string s(name);
+
+        for (auto& c : s) {
+            if (c == '_')
+                c = '-';
+            else
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+        return s;
+    }
+
     std::vector<task*> task_manager::find_by_alias(std::string_view alias_name)
     {
         std::vector<task*> v;
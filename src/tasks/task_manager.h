@@ -87,10 +87,42 @@ namespace mob {
         // alias map
         alias_map aliases_;
 
+        // normalized name -> tasks having that name, see normalize_name()
+        std::unordered_map<std::string, std::vector<task*>> names_;
+
+        // the normalized names of all tasks, in the same order as all_, so globs
+        // can be matched without converting the names every time
+        std::vector<std::pair<task*, std::vector<std::string>>> normalized_;
+
+        // pattern -> tasks matching that glob
+        std::unordered_map<std::string, std::vector<task*>> globs_;
+
+        // whether names_ and normalized_ are up to date, reset in register_task()
+        bool indexed_ = false;
+
+        // find() is called from the lookup threads started in resolve_paths() and
+        // from tasks, locked while using the index or the glob cache
+        std::mutex index_mutex_;
+
         // used by find(), returns tasks matching the given glob
         //
         std::vector<task*> find_by_pattern(std::string_view pattern);
 
+        // used by find_by_pattern(), builds names_ and normalized_ if they're out
+        // of date, must be called with index_mutex_ locked
+        //
+        void build_index();
+
+        // used by find_by_pattern(), matches the glob against the normalized names
+        // of all tasks
+        //
+        std::vector<task*> match_glob(std::string_view pattern) const;
+
+        // lowercases the given name and changes underscores to dashes, which
+        // makes names compare the same way as task::name_matches()
+        //
+        static std::string normalize_name(std::string_view name);
+
         // used by find(), looks for an alias with the given name and returns
         // matching tasks
         //
@@ -96,6 +96,18 @@ namespace mob::tasks {
         //
         fs::path source_path() const;
 
+        // preset from the cmake_preset option, or the visual studio preset from
+        // cmake_common; when cmake runs without a preset, its cache variables are
+        // given on the command line instead, see preset()
+        //
+        std::string configure_preset() const;
+
+        // queues the repo in the git_submodule_adder if the git_maintenance
+        // option is set; called once the project is built, which is done by the
+        // superbuild task when it's enabled
+        //
+        void queue_git_maintenance() const;
+
     protected:
         void do_clean(clean c) override;
         void do_fetch() override;
@@ -104,6 +116,76 @@ namespace mob::tasks {
     private:
         std::string repo_;
         std::string project_;
+
+        // generator from the cmake_generator option
+        //
+        cmake::generators generator() const;
+
+        // preset given to cmake: configure_preset(), or nothing with the ninja
+        // generator if the cmake_preset option is empty
+        //
+        std::string preset() const;
+
+        // builds the project with generate_and_build(), unless it has nothing to
+        // build, is built by the superbuild task or is benchmarked
+        //
+        void build();
+
+        // runs cmake generate and builds the install target; `tuning` enables
+        // the unity build and precompiled header options from the ini, `cache`
+        // enables the compiler cache
+        //
+        void generate_and_build(bool tuning, bool cache);
+
+        // builds the project from scratch with and without `tuning`, see
+        // generate_and_build(), and shows the times for both
+        //
+        void benchmark();
+    };
+
+    // builds all the enabled ModOrganizer projects as a single cmake project
+    // when the superbuild option in [cmake] is set, see superbuild.cpp
+    //
+    class superbuild : public task {
+    public:
+        superbuild();
+
+        // only enabled if the superbuild option is set and at least one
+        // ModOrganizer task is enabled
+        //
+        bool enabled() const override;
+
+    protected:
+        void do_clean(clean c) override;
+        void do_build_and_install() override;
+
+    private:
+        // generator from the cmake_generator option
+        //
+        cmake::generators generator() const;
+
+        // writes modorganizer_super/CMakeLists.txt with an add_subdirectory()
+        // for each of the given projects
+        //
+        void write_cmakelists(const std::vector<const modorganizer*>& projects);
+
+        // writes modorganizer_super/vcpkg.json and vcpkg-configuration.json with
+        // the dependencies of all the given projects, since vcpkg only reads the
+        // manifest of the top-level project
+        //
+        void write_vcpkg_manifest(const std::vector<const modorganizer*>& projects);
+
+        // cache variables from the presets of all the given projects, which
+        // can't be used for the superproject
+        //
+        std::map<std::string, std::string>
+        cache_variables(const std::vector<const modorganizer*>& projects);
+
+        // writes the file if its content is different, rewriting the same content
+        // would still change the timestamp and make the build system run cmake
+        // again
+        //
+        void write_if_changed(const fs::path& file, const std::string& s);
     };
 
     class stylesheets : public task {
@@ -247,6 +329,10 @@ namespace mob::tasks {
         cmake create_cmake_tool(arch, cmake::ops = cmake::generate) const;
         msbuild create_msbuild_tool(arch, msbuild::ops = msbuild::build,
                                     config = config::release) const;
+
+        // generator from the cmake_generator option
+        //
+        cmake::generators generator() const;
     };
 
 }  // namespace mob::tasks
@@ -46,11 +46,18 @@ namespace mob::tasks {
         }
 
         if (is_set(c, clean::rebuild)) {
-            // msbuild clean
-            run_tool(create_msbuild_tool(arch::x86, msbuild::clean,
-                                         task_conf().configuration()));
-            run_tool(create_msbuild_tool(arch::x64, msbuild::clean,
-                                         task_conf().configuration()));
+            if (generator() == cmake::ninja) {
+                // deletes the build directories, they're regenerated below
+                run_tool(create_cmake_tool(arch::x86, cmake::clean));
+                run_tool(create_cmake_tool(arch::x64, cmake::clean));
+            }
+            else {
+                // msbuild clean
+                run_tool(create_msbuild_tool(arch::x86, msbuild::clean,
+                                             task_conf().configuration()));
+                run_tool(create_msbuild_tool(arch::x64, msbuild::clean,
+                                             task_conf().configuration()));
+            }
         }
     }
 
@@ -76,21 +83,73 @@ namespace mob::tasks {
     {
         run_tool(create_cmake_tool(arch::x64));
         run_tool(create_cmake_tool(arch::x86));
-        run_tool(create_msbuild_tool(arch::x64, msbuild::build,
-                                     task_conf().configuration()));
-        run_tool(create_msbuild_tool(arch::x86, msbuild::build,
-                                     task_conf().configuration()));
+
+        if (generator() == cmake::ninja) {
+            // builds the same default targets as the solution
+            run_tool(create_cmake_tool(arch::x64, cmake::build));
+            run_tool(create_cmake_tool(arch::x86, cmake::build));
+        }
+        else {
+            run_tool(create_msbuild_tool(arch::x64, msbuild::build,
+                                         task_conf().configuration()));
+            run_tool(create_msbuild_tool(arch::x86, msbuild::build,
+                                         task_conf().configuration()));
+        }
     }
 
     cmake usvfs::create_cmake_tool(arch a, cmake::ops o) const
     {
-        return std::move(
-            cmake(o)
-                .root(source_path())
-                .def("CMAKE_INSTALL_PREFIX:PATH", conf().path().install())
-                .generator(cmake::vs)
-                .preset(a == arch::x64 ? "vs2022-windows-x64" : "vs2022-windows-x86")
-                .arg("-DBUILD_TESTING=OFF"));
+        const std::string default_preset =
+            (a == arch::x64 ? "vs2022-windows-x64" : "vs2022-windows-x86");
+
+        // the default presets force an architecture, which ninja doesn't support,
+        // so don't use one at all; with ninja, a preset from the ini gets a build
+        // directory for each architecture, see cmake::preset(), but visual studio
+        // needs a preset for each, so -x64 and -x86 are appended to it
+        auto preset = task_conf().cmake_preset();
+
+        if (generator() != cmake::ninja) {
+            if (preset.empty())
+                preset = default_preset;
+            else
+                preset += (a == arch::x64 ? "-x64" : "-x86");
+        }
+
+        cmake c(o);
+
+        c.root(source_path())
+            .def("CMAKE_INSTALL_PREFIX:PATH", conf().path().install())
+            .generator(generator())
+            .compiler_cache(true)
+            .preset(preset)
+            .arg("-DBUILD_TESTING=OFF");
+
+        // ninja is single-config, the configuration is picked when generating;
+        // the architecture also selects the vcvars environment, which is where
+        // ninja gets the compiler
+        if (generator() == cmake::ninja) {
+            c.architecture(a)
+                .configuration_types({task_conf().configuration()})
+                .configuration(task_conf().configuration());
+        }
+
+        // without a preset, its cache variables are still needed
+        if (preset.empty())
+            c.cache_variables_from(default_preset);
+
+        // the preset normally sets this
+        const auto vcpkg_toolchain =
+            conf().path().vcpkg() / "scripts" / "buildsystems" / "vcpkg.cmake";
+
+        if (preset.empty() && exists(vcpkg_toolchain))
+            c.def("CMAKE_TOOLCHAIN_FILE", vcpkg_toolchain);
+
+        return c;
+    }
+
+    cmake::generators usvfs::generator() const
+    {
+        return cmake::parse_generator(task_conf().cmake_generator());
     }
 
     msbuild usvfs::create_msbuild_tool(arch a, msbuild::ops o, config c) const
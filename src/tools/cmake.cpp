@@ -5,6 +5,10 @@
 namespace mob {
 
     namespace {
+        // stats for compiler_cache_stats()
+        std::map<std::string, cmake::cache_stats> g_cache_stats;
+        std::mutex g_cache_stats_mutex;
+
         std::string config_to_string(config c)
         {
             switch (c) {
@@ -17,10 +21,100 @@ namespace mob {
             }
             gcx().bail_out(context::generic, "unknow configuration type {}", c);
         }
+
+        // returns the configure preset `name` from the CMakePresets.json and
+        // CMakeUserPresets.json in `root`, followed by every preset it inherits
+        // from, closest first; empty if the preset doesn't exist
+        //
+        std::vector<nlohmann::json> resolve_preset(const fs::path& root,
+                                                   const std::string& name)
+        {
+            // configure presets from both files, by name
+            std::map<std::string, nlohmann::json> presets;
+
+            for (auto&& file_name : {"CMakePresets.json", "CMakeUserPresets.json"}) {
+                const auto file = root / file_name;
+                if (!fs::exists(file))
+                    continue;
+
+                const auto json = nlohmann::json::parse(
+                    op::read_text_file(gcx(), encodings::utf8, file), nullptr, false);
+
+                if (json.is_discarded() || !json.contains("configurePresets"))
+                    continue;
+
+                for (auto&& p : json["configurePresets"])
+                    presets[p.value("name", "")] = p;
+            }
+
+            std::vector<std::string> names = {name};
+            std::vector<nlohmann::json> v;
+
+            for (std::size_t i = 0; i < names.size(); ++i) {
+                auto itor = presets.find(names[i]);
+                if (itor == presets.end())
+                    continue;
+
+                const auto& p = itor->second;
+                v.push_back(p);
+
+                if (p.contains("inherits")) {
+                    const auto& in = p["inherits"];
+
+                    if (in.is_string())
+                        names.push_back(in.get<std::string>());
+                    else if (in.is_array())
+                        for (auto&& n : in)
+                            names.push_back(n.get<std::string>());
+                }
+            }
+
+            return v;
+        }
+
+        // expands the macros cmake supports in preset values, like
+        // `${sourceDir}` and `$env{NAME}`; unknown macros are left alone
+        //
+        std::string expand_preset_macros(std::string s, const fs::path& root,
+                                         const std::string& preset, const env& e)
+        {
+            const std::pair<std::string, std::string> macros[] = {
+                {"${sourceDir}", path_to_utf8(root)},
+                {"${sourceParentDir}", path_to_utf8(root.parent_path())},
+                {"${sourceDirName}", path_to_utf8(root.filename())},
+                {"${presetName}", preset},
+                {"${hostSystemName}", "Windows"},
+                {"${pathListSep}", ";"},
+                {"${dollar}", "$"}};
+
+            for (auto&& [from, to] : macros)
+                s = replace_all(s, from, to);
+
+            // $env{NAME} and $penv{NAME}
+            for (std::string_view prefix : {"$env{", "$penv{"}) {
+                for (;;) {
+                    const auto start = s.find(prefix);
+                    if (start == std::string::npos)
+                        break;
+
+                    const auto end = s.find('}', start);
+                    if (end == std::string::npos)
+                        break;
+
+                    const auto name =
+                        s.substr(start + prefix.size(), end - start - prefix.size());
+
+                    s.replace(start, end - start + 1, e.get(name));
+                }
+            }
+
+            return s;
+        }
     }  // namespace
 
     cmake::cmake(ops o)
-        : basic_process_runner("cmake"), op_(o), gen_(vs), arch_(arch::def)
+        : basic_process_runner("cmake"), op_(o), gen_(vs), arch_(arch::def),
+          cache_(false), unity_batch_(0)
     {
     }
 
@@ -29,6 +123,34 @@ namespace mob {
         return conf().tool().get("cmake");
     }
 
+    cmake::generators cmake::parse_generator(std::string_view name)
+    {
+        if (name == "vs")
+            return vs;
+        else if (name == "ninja")
+            return ninja;
+
+        gcx().bail_out(context::conf,
+                       "unknown cmake generator '{}', must be 'vs' or 'ninja'", name);
+    }
+
+    std::string cmake::install_target(generators g)
+    {
+        // visual studio uses uppercase names for the special targets
+        return (g == vs ? "INSTALL" : "install");
+    }
+
+    std::vector<cmake::cache_stats> cmake::compiler_cache_stats()
+    {
+        std::scoped_lock lock(g_cache_stats_mutex);
+
+        std::vector<cache_stats> v;
+        for (auto&& [_, s] : g_cache_stats)
+            v.push_back(s);
+
+        return v;
+    }
+
     cmake& cmake::generator(generators g)
     {
         gen_ = g;
@@ -83,6 +205,12 @@ namespace mob {
         return *this;
     }
 
+    cmake& cmake::cache_variables_from(const std::string& preset)
+    {
+        variables_preset_ = preset;
+        return *this;
+    }
+
     cmake& cmake::arg(std::string s)
     {
         std::replace(s.begin(), s.end(), '\\', '/');
@@ -90,6 +218,25 @@ namespace mob {
         return *this;
     }
 
+    cmake& cmake::compiler_cache(bool b)
+    {
+        cache_ = b;
+        return *this;
+    }
+
+    cmake& cmake::unity_build(bool b, int batch)
+    {
+        unity_       = b;
+        unity_batch_ = batch;
+        return *this;
+    }
+
+    cmake& cmake::precompiled_headers(std::vector<std::string> headers)
+    {
+        pch_ = std::move(headers);
+        return *this;
+    }
+
     cmake& cmake::architecture(arch a)
     {
         arch_ = a;
@@ -187,14 +334,26 @@ namespace mob {
             p = p.arg("--preset").arg(preset_);
         }
 
+        // given first so every -D below overrides them, cmake keeps the last one
+        if (!variables_preset_.empty()) {
+            for (auto&& [k, v] : preset_cache_variables(root_, variables_preset_))
+                p = p.arg("-D" + k + "=", v, process::quote);
+        }
+
         if (!config_types_.empty()) {
-            std::string types;
-            for (const auto& c : config_types_) {
-                if (!types.empty())
-                    types += ";";
-                types += config_to_string(c);
+            if (single_config()) {
+                // only one configuration can be generated
+                p = p.arg("-DCMAKE_BUILD_TYPE=" + config_to_string(config_types_[0]));
+            }
+            else {
+                std::string types;
+                for (const auto& c : config_types_) {
+                    if (!types.empty())
+                        types += ";";
+                    types += config_to_string(c);
+                }
+                p = p.arg("-DCMAKE_CONFIGURATION_TYPES=" + types);
             }
-            p = p.arg("-DCMAKE_CONFIGURATION_TYPES=" + types);
         }
 
         p = p.arg("-DCMAKE_INSTALL_MESSAGE=" +
@@ -208,15 +367,61 @@ namespace mob {
 
         p.args(args_);
 
+        if (use_compiler_cache()) {
+            if (genstring_.empty() && gen_ == vs) {
+                cx().warning(context::generic,
+                             "the compiler cache is not supported by the visual "
+                             "studio generator, see the cmake_generator option");
+            }
+            else {
+                const auto launcher = conf().cache().launcher();
+
+                p.arg("-DCMAKE_C_COMPILER_LAUNCHER=", launcher,
+                      process::forward_slashes)
+                    .arg("-DCMAKE_CXX_COMPILER_LAUNCHER=", launcher,
+                         process::forward_slashes);
+
+                // /Zi writes to a shared pdb, which can't be cached; /Z7 puts
+                // debug information in the object files instead
+                p.arg("-DCMAKE_POLICY_DEFAULT_CMP0141=NEW")
+                    .arg("-DCMAKE_MSVC_DEBUG_INFORMATION_FORMAT=Embedded");
+            }
+        }
+
+        if (unity_) {
+            p.arg("-DCMAKE_UNITY_BUILD=" + std::string(*unity_ ? "ON" : "OFF"));
+
+            if (*unity_ && unity_batch_ > 0) {
+                p.arg("-DCMAKE_UNITY_BUILD_BATCH_SIZE=" +
+                      std::to_string(unity_batch_));
+            }
+        }
+
+        if (pch_) {
+            p.arg("-DCMAKE_PROJECT_INCLUDE=", write_pch_script(),
+                  process::forward_slashes);
+        }
+
+        if (!preset_.empty() && genstring_.empty() && gen_ == ninja) {
+            check_ninja_preset();
+
+            // override the generator and the build directory, which is also used
+            // by do_build()
+            p.arg("-G", "\"" + g.name + "\"").arg("-B", build_path());
+        }
+
         if (preset_.empty()) {
 
             if (genstring_.empty()) {
                 // there's always a generator name, but some generators don't need
                 // an architecture flag, like jom, so get_arch() might return an empty
                 // string
-                p.arg("-G", "\"" + g.name + "\"")
-                    .arg(g.get_arch(arch_))
-                    .arg(g.get_host(conf().cmake().host()));
+                p.arg("-G", "\"" + g.name + "\"").arg(g.get_arch(arch_));
+
+                // ninja doesn't support toolsets, the host compiler comes from
+                // the vcvars environment instead
+                if (gen_ != ninja)
+                    p.arg(g.get_host(conf().cmake().host()));
             }
             else {
                 // verbatim generator string
@@ -230,30 +435,303 @@ namespace mob {
                 p.arg(cmd_);
         }
 
-        p.env(env::vs(arch_)
+        // qt's tools are used when generating ModOrganizer projects
+        p.env(qt::with_bin_path(env::vs(arch_))
                   .set("CXXFLAGS", "/wd4566")
                   .set("VCPKG_ROOT", absolute(conf().path().vcpkg()).string()))
             .cwd(preset_.empty() ? build_path() : root_);
 
+        // generating is slow even when nothing changed, skip it if the cache
+        // exists and the command line and root cmake files are the same as the
+        // last time; anything deeper is picked up by the build system itself,
+        // which re-runs cmake when one of its inputs changes
+        const auto hash  = generate_hash(p);
+        const auto stamp = generate_stamp();
+        const auto cache = build_path() / "CMakeCache.txt";
+
+        if (fs::exists(cache) && fs::exists(stamp)) {
+            const auto last =
+                op::read_text_file(cx(), encodings::utf8, stamp, op::optional);
+
+            if (trim_copy(last) == hash) {
+                cx().debug(context::bypass, "cmake inputs unchanged, not generating");
+                return;
+            }
+        }
+
+        // a failed generation must not leave an old stamp behind
+        op::delete_file(cx(), stamp, op::optional);
+
         execute_and_join(p);
+
+        // only stamp the directory if cmake actually generated something in it,
+        // presets may have their own binaryDir
+        if (fs::exists(cache))
+            op::write_text_file(cx(), encodings::utf8, stamp, hash);
+    }
+
+    std::string cmake::generate_hash(const process& p) const
+    {
+        std::uint64_t h = fnv1a(p.command_line());
+        h               = fnv1a(path_to_utf8(p.cwd()), h);
+        h               = fnv1a(path_to_utf8(absolute(conf().path().vcpkg())), h);
+
+        // the script for precompiled headers is only given as a path
+        if (pch_)
+            h = fnv1a(join(*pch_, " "), h);
+
+        // the compiler is found by cmake from the environment, which changes with
+        // the visual studio installation, toolset and sdk; the launchers and
+        // compilers can also be given in the environment instead of the command
+        // line
+        const auto e = env::vs(arch_);
+
+        for (auto&& name :
+             {"PATH", "INCLUDE", "LIB", "LIBPATH", "VCToolsVersion",
+              "VCToolsInstallDir", "VSCMD_VER", "WindowsSDKVersion",
+              "CMAKE_C_COMPILER_LAUNCHER", "CMAKE_CXX_COMPILER_LAUNCHER", "CC",
+              "CXX"}) {
+            h = fnv1a(name, h);
+            h = fnv1a(e.get(name), h);
+        }
+
+        // the build system checks every CMakeLists.txt, but not the presets
+        for (auto&& name :
+             {"CMakeLists.txt", "CMakePresets.json", "CMakeUserPresets.json"}) {
+            const auto file = root_ / name;
+
+            h = fnv1a(name, h);
+
+            if (fs::exists(file))
+                h = fnv1a(op::read_text_file(cx(), encodings::dont_know, file), h);
+        }
+
+        return std::format("{:016x}", h);
+    }
+
+    void cmake::check_ninja_preset() const
+    {
+        // the preset and everything it inherits from
+        for (auto&& p : resolve_preset(root_, preset_)) {
+            // `external` only tells the ide what to use, it doesn't end up in the
+            // command line
+            auto forced = [&](const char* key) {
+                if (!p.contains(key))
+                    return false;
+
+                const auto& v = p[key];
+                return !v.is_object() || v.value("strategy", "set") != "external";
+            };
+
+            if (p.value("generator", "").starts_with("Visual Studio") ||
+                forced("architecture") || forced("toolset")) {
+                gcx().bail_out(
+                    context::generic,
+                    "cmake preset '{}' in {} is made for visual studio and can't "
+                    "be used with the ninja generator, set cmake_preset to a preset "
+                    "without a generator, architecture or toolset, or leave it "
+                    "empty",
+                    preset_, path_to_utf8(root_));
+            }
+        }
+    }
+
+    std::map<std::string, std::string>
+    cmake::preset_cache_variables(const fs::path& root, const std::string& preset)
+    {
+        // VCPKG_ROOT is given to cmake when generating, see do_generate()
+        const auto e = this_env::get().set(
+            "VCPKG_ROOT", path_to_utf8(absolute(conf().path().vcpkg())));
+
+        std::map<std::string, std::string> vars;
+
+        // names seen so far; closest preset first, so inherited values are only
+        // used when the variable wasn't set or unset yet
+        std::set<std::string> seen;
+
+        for (auto&& p : resolve_preset(root, preset)) {
+            if (!p.contains("cacheVariables"))
+                continue;
+
+            for (auto&& [name, v] : p["cacheVariables"].items()) {
+                std::string key = name;
+                nlohmann::json value = v;
+
+                // {"type": "BOOL", "value": "ON"}
+                if (v.is_object()) {
+                    if (v.contains("type"))
+                        key += ":" + v["type"].get<std::string>();
+
+                    value = v.value("value", nlohmann::json());
+                }
+
+                if (!seen.insert(name).second)
+                    continue;
+
+                // null unsets a variable inherited from another preset
+                if (value.is_boolean()) {
+                    vars.emplace(key, value.get<bool>() ? "TRUE" : "FALSE");
+                }
+                else if (value.is_string()) {
+                    vars.emplace(key, expand_preset_macros(value.get<std::string>(),
+                                                           root, preset, e));
+                }
+            }
+        }
+
+        return vars;
+    }
+
+    fs::path cmake::generate_stamp() const
+    {
+        return build_path() / "mob_generate.stamp";
+    }
+
+    fs::path cmake::write_pch_script() const
+    {
+        const auto file = build_path() / "mob_pch.cmake";
+
+        std::string s = "# generated by mob for the cmake_pch option\n";
+
+        if (!pch_->empty()) {
+            // the script is included after every project() call, but only the
+            // top-level one matters; the deferred call runs once all the
+            // subdirectories have been processed and all the targets exist
+            s += "include_guard(GLOBAL)\n"
+                 "\n"
+                 "function(mob_precompile_headers dir)\n"
+                 "    get_property(targets DIRECTORY \"${dir}\" "
+                 "PROPERTY BUILDSYSTEM_TARGETS)\n"
+                 "\n"
+                 "    foreach(target ${targets})\n"
+                 "        get_target_property(type ${target} TYPE)\n"
+                 "        get_target_property(pch ${target} PRECOMPILE_HEADERS)\n"
+                 "\n"
+                 "        if(NOT pch AND type MATCHES "
+                 "\"^(EXECUTABLE|SHARED_LIBRARY|STATIC_LIBRARY|MODULE_LIBRARY)$\")\n"
+                 "            target_precompile_headers(${target} PRIVATE " +
+                 join(*pch_, " ") +
+                 ")\n"
+                 "        endif()\n"
+                 "    endforeach()\n"
+                 "\n"
+                 "    get_property(subdirs DIRECTORY \"${dir}\" "
+                 "PROPERTY SUBDIRECTORIES)\n"
+                 "\n"
+                 "    foreach(subdir ${subdirs})\n"
+                 "        mob_precompile_headers(\"${subdir}\")\n"
+                 "    endforeach()\n"
+                 "endfunction()\n"
+                 "\n"
+                 "cmake_language(DEFER CALL mob_precompile_headers "
+                 "\"${CMAKE_SOURCE_DIR}\")\n";
+        }
+
+        // cmake runs again when one of its inputs is touched, only write the
+        // file if it changed
+        if (fs::exists(file)) {
+            const auto current =
+                op::read_text_file(cx(), encodings::utf8, file, op::optional);
+
+            if (current == s)
+                return file;
+        }
+
+        op::create_directories(cx(), build_path());
+        op::write_text_file(cx(), encodings::utf8, file, s);
+
+        return file;
     }
 
     void cmake::do_build()
     {
+        // share of the global cpu pool, held until the build is finished
+        const auto tokens = cpu_pool::instance().acquire();
+
+        // ninja appends to its log, only the entries added by this build are
+        // used for the timings
+        const auto ninja_log = build_path() / ".ninja_log";
+        const auto ninja_log_size =
+            (gen_ == ninja && fs::exists(ninja_log)) ? fs::file_size(ninja_log) : 0;
+
+        // projects that fail because of locked files are built again, see
+        // build_loop()
+        const bool built = build_loop(cx(), [&](auto&& failed) {
+            auto r = run_build(failed.empty() ? targets_ : failed, tokens.count());
+
+            // msbuild's project performance summary, for the report at the end
+            // of the build
+            for (auto&& t : r.timings)
+                add_build_timing({path_to_utf8(root_.filename()), t.target, t.time});
+
+            return r;
+        });
+
+        if (gen_ == ninja)
+            collect_ninja_timings(ninja_log, ninja_log_size);
+
+        if (use_compiler_cache() && gen_ == ninja)
+            collect_compiler_cache_stats();
+
+        if (!built)
+            cx().bail_out(context::generic, "cmake build returned {}", exit_code());
+    }
+
+    build_attempt cmake::run_build(const std::vector<std::string>& targets,
+                                   std::size_t jobs)
+    {
+        build_attempt r;
+
         auto p = process()
                      .stdout_encoding(encodings::utf8)
                      .stderr_encoding(encodings::utf8)
                      .binary(binary())
+                     .flags(process::allow_failure)
                      .arg("--build")
                      .arg(build_path())
                      .arg("--config")
                      .arg(config_to_string(config_));
 
-        for (auto& target : targets_) {
+        for (auto& target : targets) {
             p = p.arg("--target").arg(target);
         }
 
-        execute_and_join(p);
+        // ninja needs the compiler in the path; qt is needed by the install
+        // steps of ModOrganizer projects, which run windeployqt
+        if (gen_ == ninja) {
+            auto e = qt::with_bin_path(env::vs(arch_));
+
+            if (use_compiler_cache())
+                set_compiler_cache_env(e);
+
+            p.env(e);
+        }
+        else {
+            p.env(qt::with_bin_path(this_env::get()));
+        }
+
+        p.arg("--parallel").arg(std::to_string(jobs));
+
+        // the arguments after `--` are given to msbuild
+        if (genstring_.empty() && gen_ == vs) {
+            // --parallel is only -maxCpuCount, the number of projects built at
+            // the same time; each project still runs one cl.exe per core with
+            // /MP, so cap the total number of compiler processes like msbuild
+            // does
+            p.arg("--")
+                .arg("-property:UseMultiToolTask=true")
+                .arg("-property:EnforceProcessCountAcrossBuilds=true")
+                .arg("-property:CL_MPCount=" + std::to_string(jobs));
+
+            // time spent in each project for the report at the end of the build
+            p.arg("-consoleLoggerParameters:PerformanceSummary");
+        }
+
+        // failures are handled by build_loop()
+        filter_build_output(p, r);
+
+        r.success = (execute_and_join(p) == 0);
+        return r;
     }
 
     void cmake::do_install()
@@ -262,12 +740,220 @@ namespace mob {
                              .stdout_encoding(encodings::utf8)
                              .stderr_encoding(encodings::utf8)
                              .binary(binary())
+                             .env(qt::with_bin_path(this_env::get()))
                              .arg("--install")
                              .arg(build_path())
                              .arg("--config")
                              .arg(config_to_string(config_)));
     }
 
+    bool cmake::use_compiler_cache() const
+    {
+        return (cache_ && !conf().cache().launcher().empty());
+    }
+
+    bool cmake::is_ccache()
+    {
+        auto stem = path_to_utf8(conf().cache().launcher().stem());
+
+        std::transform(stem.begin(), stem.end(), stem.begin(), [](char c) {
+            return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        });
+
+        return (stem == "ccache");
+    }
+
+    fs::path cmake::compiler_cache_log() const
+    {
+        return build_path() / "ccache_stats.log";
+    }
+
+    void cmake::set_compiler_cache_env(env& e) const
+    {
+        const auto dir = path_to_utf8(conf().cache().directory());
+
+        if (is_ccache()) {
+            e.set("CCACHE_DIR", dir);
+
+            // every compilation appends its result to this file, it's read in
+            // collect_compiler_cache_stats() to get numbers for this build only
+            e.set("CCACHE_STATSLOG", path_to_utf8(compiler_cache_log()));
+        }
+        else {
+            // sccache
+            e.set("SCCACHE_DIR", dir);
+        }
+    }
+
+    void cmake::collect_compiler_cache_stats()
+    {
+        // sccache only has global statistics for its server
+        if (!is_ccache())
+            return;
+
+        const auto log = compiler_cache_log();
+        if (!fs::exists(log))
+            return;
+
+        cache_stats s;
+        s.project = path_to_utf8(root_.filename());
+
+        // statistics that mean the compilation couldn't be cached at all, as
+        // opposed to storage counters like "direct_cache_miss" or
+        // "local_storage_write" that are logged alongside a hit or a miss
+        static const std::set<std::string_view> uncacheable = {
+            "autoconf_test",
+            "bad_compiler_arguments",
+            "bad_input_file",
+            "bad_output_file",
+            "called_for_link",
+            "called_for_preprocessing",
+            "compile_failed",
+            "compiler_check_failed",
+            "could_not_find_compiler",
+            "could_not_use_modules",
+            "could_not_use_precompiled_header",
+            "disabled",
+            "error_hashing_extra_file",
+            "internal_error",
+            "missing_cache_file",
+            "modified_input_file",
+            "multiple_source_files",
+            "no_input_file",
+            "output_to_stdout",
+            "preprocessor_error",
+            "recache",
+            "unsupported_code_directive",
+            "unsupported_compiler_option",
+            "unsupported_environment_variable",
+            "unsupported_source_encoding",
+            "unsupported_source_language"};
+
+        // the log has a "# file" line for each compilation, followed by one line
+        // per statistic, such as "direct_cache_hit" or "cache_miss"; each
+        // compilation is counted once, a hit wins over anything else
+        enum class result { none, hit, miss, uncacheable };
+        result r = result::none;
+
+        auto count = [&] {
+            switch (r) {
+            case result::hit:
+                ++s.hits;
+                break;
+
+            case result::miss:
+                ++s.misses;
+                break;
+
+            case result::uncacheable:
+                ++s.uncacheable;
+                break;
+
+            case result::none:
+                break;
+            }
+
+            r = result::none;
+        };
+
+        const auto content = op::read_text_file(cx(), encodings::utf8, log);
+
+        for_each_line(content, [&](std::string_view line) {
+            if (line.starts_with("#")) {
+                count();
+                return;
+            }
+
+            if (line.ends_with("_cache_hit"))
+                r = result::hit;
+            else if (line == "cache_miss" && r != result::hit)
+                r = result::miss;
+            else if (uncacheable.contains(line) && r == result::none)
+                r = result::uncacheable;
+        });
+
+        count();
+
+        op::delete_file(cx(), log, op::optional);
+
+        std::scoped_lock lock(g_cache_stats_mutex);
+
+        auto& total = g_cache_stats[s.project];
+        total.project = s.project;
+        total.hits += s.hits;
+        total.misses += s.misses;
+        total.uncacheable += s.uncacheable;
+    }
+
+    void cmake::collect_ninja_timings(const fs::path& log, std::uintmax_t offset)
+    {
+        if (!fs::exists(log))
+            return;
+
+        auto content =
+            op::read_text_file(cx(), encodings::dont_know, log, op::optional);
+
+        // ninja rewrites the log when it has too many stale entries, in which
+        // case there's no way to know which ones are new
+        if (offset > content.size()) {
+            cx().debug(context::generic, "ninja log was rewritten, no timings");
+            return;
+        }
+
+        content.erase(0, offset);
+
+        // each line is "start_ms\tend_ms\tmtime\toutput\thash", outputs that
+        // are built again are added to the log again, only keep the last
+        std::map<std::string, std::chrono::milliseconds> outputs;
+
+        for_each_line(content, [&](std::string_view line) {
+            if (line.starts_with("#"))
+                return;
+
+            const auto cols = split(std::string(line), "\t");
+            if (cols.size() < 4)
+                return;
+
+            try {
+                const auto start = std::stoll(cols[0]);
+                const auto end   = std::stoll(cols[1]);
+
+                outputs[cols[3]] = std::chrono::milliseconds(end - start);
+            }
+            catch (std::exception&) {
+                // bad line, ignore
+            }
+        });
+
+        // object files are in "CMakeFiles/target.dir/", anything else, like
+        // dlls, is attributed to the name of the file, which is typically the
+        // same as the target
+        static const std::regex target_re(R"(CMakeFiles/([^/]+)\.dir/)");
+
+        std::map<std::string, std::chrono::milliseconds> targets;
+
+        for (auto&& [output, ms] : outputs) {
+            std::smatch m;
+
+            if (std::regex_search(output, m, target_re))
+                targets[m[1].str()] += ms;
+            else
+                targets[path_to_utf8(fs::path(output).stem())] += ms;
+        }
+
+        const auto project = path_to_utf8(root_.filename());
+
+        for (auto&& [target, ms] : targets)
+            add_build_timing({project, target, ms});
+    }
+
+    bool cmake::single_config() const
+    {
+        // generators given as a string are assumed to be multi-config, which is
+        // how this worked before ninja was added
+        return (genstring_.empty() && gen_ == ninja);
+    }
+
     void cmake::do_clean()
     {
         cx().trace(context::rebuild, "deleting all generator directories");
@@ -280,6 +966,9 @@ namespace mob {
             // jom doesn't need -A for architectures
             {generators::jom, {"build", "NMake Makefiles JOM", "", ""}},
 
+            // ninja doesn't need -A either, the architecture comes from vcvars
+            {generators::ninja, {"ninjabuild", "Ninja", "", ""}},
+
             {generators::vs,
              {"vsbuild", "Visual Studio " + vs::version() + " " + vs::year(), "Win32",
               "x64"}}};
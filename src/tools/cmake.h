@@ -4,7 +4,7 @@ namespace mob {
 
     // a tool that runs `cmake ..` by default in a given directory
     //
-    // supports either visual studio or jom/nmake and x86/x64 architectures
+    // supports either visual studio, jom/nmake or ninja and x86/x64 architectures
     //
     class cmake : public basic_process_runner {
     public:
@@ -19,10 +19,49 @@ namespace mob {
             vs = 0x01,
 
             // generates build files for jom/nmake
-            jom = 0x02
+            jom = 0x02,
+
+            // generates build files for ninja, single configuration; the vcvars
+            // environment is used for both generating and building
+            ninja = 0x04
         };
         using enum generators;
 
+        // converts a generator name from the ini ("vs" or "ninja") to the enum,
+        // bails out if the name is unknown
+        //
+        static generators parse_generator(std::string_view name);
+
+        // name of the target that installs everything, "INSTALL" for visual
+        // studio and "install" for the others
+        //
+        static std::string install_target(generators g);
+
+        // cache variables set by the given configure preset in `root` and the
+        // presets it inherits from, as `name` or `name:type` -> value, with the
+        // macros expanded; used to get the same configuration without the preset
+        //
+        static std::map<std::string, std::string>
+        preset_cache_variables(const fs::path& root, const std::string& preset);
+
+        // compiler cache results for one project, see compiler_cache()
+        //
+        struct cache_stats {
+            // name of the root directory, such as "uibase"
+            std::string project;
+
+            // compilations found in the cache, compiled and stored in the cache,
+            // and compiled without the cache because it couldn't be used
+            int hits        = 0;
+            int misses      = 0;
+            int uncacheable = 0;
+        };
+
+        // returns the statistics gathered by all the builds that used the
+        // compiler cache so far, sorted by project; only available with ccache
+        //
+        static std::vector<cache_stats> compiler_cache_stats();
+
         // what run() will do
         //
         enum class ops {
@@ -95,12 +134,44 @@ namespace mob {
 
         // set a preset to run with cmake --preset
         //
+        // with the ninja generator, `-G Ninja` and `-B build_path()` are also given
+        // to override whatever the preset has; the preset must not force an
+        // architecture or toolset, which ninja doesn't support
+        //
         cmake& preset(const std::string& s);
 
+        // gives the cache variables of the given configure preset on the command
+        // line instead of running with the preset, for when it can't be used;
+        // anything else mob sets, like def() or configuration_types(), takes
+        // precedence
+        //
+        cmake& cache_variables_from(const std::string& preset);
+
         // adds an arbitrary argument, passed verbatim
         //
         cmake& arg(std::string s);
 
+        // if true and a launcher is set in [cache], generate sets it as
+        // CMAKE_<LANG>_COMPILER_LAUNCHER and build sets up its environment
+        //
+        // launchers are only supported by ninja and jom, they're ignored by
+        // visual studio
+        //
+        cmake& compiler_cache(bool b);
+
+        // sets CMAKE_UNITY_BUILD on generate, plus CMAKE_UNITY_BUILD_BATCH_SIZE if
+        // `batch` is not 0; when not called, whatever is in the cache is kept
+        //
+        cmake& unity_build(bool b, int batch = 0);
+
+        // headers that are precompiled for every target that doesn't already
+        // have precompiled headers, such as "<QtWidgets>"
+        //
+        // this writes a cmake script in the build directory that's given as
+        // CMAKE_PROJECT_INCLUDE, the script is empty when `headers` is empty
+        //
+        cmake& precompiled_headers(std::vector<std::string> headers);
+
         // sets the architecture, used along with the generator to create the
         // output directory name, but also to get the proper vcvars environment
         // variables for the build environment
@@ -171,6 +242,9 @@ namespace mob {
         // preset to run
         std::string preset_;
 
+        // preset to take cache variables from, see cache_variables_from()
+        std::string variables_preset_;
+
         // directory where CMakeLists.txt is
         fs::path root_;
 
@@ -202,16 +276,84 @@ namespace mob {
         // overrides `..` on the command line
         std::string cmd_;
 
+        // whether to use the compiler launcher from [cache]
+        bool cache_;
+
+        // CMAKE_UNITY_BUILD and its batch size
+        std::optional<bool> unity_;
+        int unity_batch_;
+
+        // headers to precompile, not set if precompiled_headers() wasn't called
+        std::optional<std::vector<std::string>> pch_;
+
         // deletes the build directory
         //
         void do_clean();
 
+        // hashes the command line for the given process along with the cmake
+        // files in the root directory and the compiler environment, used to
+        // detect whether generating again is necessary
+        //
+        std::string generate_hash(const process& p) const;
+
+        // file in the build directory that contains the hash of the last
+        // successful generation
+        //
+        fs::path generate_stamp() const;
+
+        // writes the script for precompiled_headers() and returns its path
+        //
+        fs::path write_pch_script() const;
+
+        // bails out if the preset, or one it inherits from, is made for visual
+        // studio, which can't be overridden by the ninja generator
+        //
+        void check_ninja_preset() const;
+
         // runs cmake
         //
         void do_generate();
         void do_build();
         void do_install();
 
+        // runs `cmake --build` once for the given targets, called by do_build()
+        // from build_loop()
+        //
+        build_attempt run_build(const std::vector<std::string>& targets,
+                                std::size_t jobs);
+
+        // whether compiler_cache() was called and there's a launcher in [cache]
+        //
+        bool use_compiler_cache() const;
+
+        // sets the cache directory for the launcher in the given environment,
+        // plus the stats log for ccache
+        //
+        void set_compiler_cache_env(env& e) const;
+
+        // reads the ccache stats log written during the build, adds the results
+        // to compiler_cache_stats() and deletes the log
+        //
+        void collect_compiler_cache_stats();
+
+        // reads the entries added to ninja's log past `offset` and adds the time
+        // spent on each target to build_timings()
+        //
+        void collect_ninja_timings(const fs::path& log, std::uintmax_t offset);
+
+        // path to the ccache stats log in the build directory
+        //
+        fs::path compiler_cache_log() const;
+
+        // whether the launcher is ccache, as opposed to sccache or others
+        //
+        static bool is_ccache();
+
+        // whether the generator only supports one configuration at a time and
+        // needs CMAKE_BUILD_TYPE instead of CMAKE_CONFIGURATION_TYPES
+        //
+        bool single_config() const;
+
         // returns a list of generators handled by this tool, same ones as in the
         // `generators` enum on top
         //
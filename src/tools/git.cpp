@@ -34,6 +34,156 @@ namespace mob::details {
             org, git_file);
     }
 
+    // whether the given string looks like a full commit hash, sha1 or sha256
+    //
+    bool is_commit_hash(std::string_view s)
+    {
+        if (s.size() != 40 && s.size() != 64)
+            return false;
+
+        for (const char c : s) {
+            if (!std::isxdigit(static_cast<unsigned char>(c)))
+                return false;
+        }
+
+        return true;
+    }
+
+    // returns the git directory for the given working tree, or an empty path
+    //
+    // .git is normally a directory, but it can also be a file containing
+    // "gitdir: path" for submodules or worktrees
+    //
+    fs::path find_git_dir(const context& cx, const fs::path& root)
+    {
+        const auto dot_git = root / ".git";
+
+        if (fs::is_directory(dot_git))
+            return dot_git;
+
+        if (!fs::is_regular_file(dot_git))
+            return {};
+
+        const auto s = trim_copy(
+            op::read_text_file(cx, encodings::utf8, dot_git, op::optional));
+
+        if (!s.starts_with("gitdir:"))
+            return {};
+
+        fs::path p = utf8_to_utf16(trim_copy(s.substr(7)));
+        if (p.is_relative())
+            p = root / p;
+
+        return p;
+    }
+
+    // resolves a ref such as "refs/heads/master" to a commit hash by looking at
+    // the loose ref first, then packed-refs; returns an empty string if not found
+    //
+    std::string read_ref(const context& cx, const fs::path& git_dir,
+                         const std::string& ref)
+    {
+        const auto loose = git_dir / utf8_to_utf16(ref);
+
+        if (fs::is_regular_file(loose)) {
+            return trim_copy(
+                op::read_text_file(cx, encodings::utf8, loose, op::optional));
+        }
+
+        const auto packed = git_dir / "packed-refs";
+        if (!fs::is_regular_file(packed))
+            return {};
+
+        const auto content =
+            op::read_text_file(cx, encodings::utf8, packed, op::optional);
+
+        std::string hash;
+
+        // lines are "<hash> <ref>", comments start with '#' and peeled tags
+        // with '^'
+        for_each_line(content, [&](std::string_view line) {
+            if (!hash.empty() || line.starts_with("#") || line.starts_with("^"))
+                return;
+
+            const auto space = line.find(' ');
+            if (space == std::string_view::npos)
+                return;
+
+            if (line.substr(space + 1) == ref)
+                hash = std::string(line.substr(0, space));
+        });
+
+        return hash;
+    }
+
+    // returns the content of HEAD in the given git directory, which is either
+    // "ref: refs/heads/branch" or a commit hash for a detached head; returns an
+    // empty string if it can't be read
+    //
+    std::string read_head(const context& cx, const fs::path& git_dir)
+    {
+        const auto head_file = git_dir / "HEAD";
+        if (!fs::is_regular_file(head_file))
+            return {};
+
+        return trim_copy(
+            op::read_text_file(cx, encodings::utf8, head_file, op::optional));
+    }
+
+    // returns the commit hash HEAD points to by reading files in the .git
+    // directory, returns an empty string if anything fails; this doesn't handle
+    // everything git does (such as reftables), callers fall back to running git
+    //
+    std::string read_head_commit(const context& cx, const fs::path& root)
+    {
+        const auto git_dir = find_git_dir(cx, root);
+        if (git_dir.empty())
+            return {};
+
+        const auto head = read_head(cx, git_dir);
+
+        // detached head contains the hash directly
+        if (!head.starts_with("ref:"))
+            return head;
+
+        return read_ref(cx, git_dir, trim_copy(head.substr(4)));
+    }
+
+    // returns the content of a .gitmodules file without the sections of the given
+    // submodules, so they can be appended again
+    //
+    std::string remove_gitmodules_sections(std::string_view content,
+                                           const std::set<std::string>& names)
+    {
+        std::string out;
+        bool skipping = false;
+
+        for_each_line(content, [&](std::string_view line) {
+            const auto tl = trim_copy(line);
+
+            if (tl.starts_with("[")) {
+                // new section, something like [submodule "name"]
+                skipping = false;
+
+                const auto open  = tl.find('"');
+                const auto close = tl.rfind('"');
+
+                if (tl.starts_with("[submodule") && open != std::string::npos &&
+                    close > open) {
+                    const auto name = tl.substr(open + 1, close - open - 1);
+                    skipping        = names.contains(name);
+                }
+            }
+
+            if (!skipping) {
+                out += line;
+                out += "\n";
+            }
+        });
+
+        return out;
+    }
+
     // creates a basic git process, used by all the functions below
     //
     [[nodiscard]] process make_process()
@@ -77,6 +227,50 @@ namespace mob::details {
         return make_process().arg("fetch").arg("-q").arg(remote).arg(branch).cwd(root);
     }
 
+    [[nodiscard]] process fetch_dry_run(const fs::path& root)
+    {
+        return make_process()
+            .flags(process::allow_failure)
+            .stderr_level(context::level::trace)
+            .arg("fetch")
+            .arg("--dry-run")
+            .arg("-q")
+            .cwd(root);
+    }
+
+    [[nodiscard]] process commit_graph_write(const fs::path& root)
+    {
+        return make_process()
+            .stderr_level(context::level::trace)
+            .arg("commit-graph")
+            .arg("write")
+            .arg("--reachable")
+            .arg("--no-progress")
+            .cwd(root);
+    }
+
+    [[nodiscard]] process multi_pack_index_write(const fs::path& root)
+    {
+        return make_process()
+            .stderr_level(context::level::trace)
+            .arg("multi-pack-index")
+            .arg("write")
+            .arg("--no-progress")
+            .cwd(root);
+    }
+
+    [[nodiscard]] process incremental_repack(const fs::path& root)
+    {
+        return make_process()
+            .stderr_level(context::level::trace)
+            .arg("maintenance")
+            .arg("run")
+            .arg("--quiet")
+            .arg("--task=loose-objects")
+            .arg("--task=incremental-repack")
+            .cwd(root);
+    }
+
     [[nodiscard]] process checkout(const fs::path& root, const std::string& what)
     {
         return make_process()
@@ -105,21 +299,64 @@ namespace mob::details {
             .cwd(root);
     }
 
-    [[nodiscard]] process add_submodule(const fs::path& root, const std::string& branch,
-                                        const std::string& submodule,
-                                        const mob::url& url)
+    [[nodiscard]] process absolute_git_dir(const fs::path& root)
+    {
+        return make_process()
+            .flags(process::allow_failure)
+            .stdout_flags(process::keep_in_string)
+            .stderr_level(context::level::trace)
+            .arg("rev-parse")
+            .arg("--absolute-git-dir")
+            .cwd(root);
+    }
+
+    [[nodiscard]] process submodule_status(const fs::path& root)
+    {
+        return make_process()
+            .flags(process::allow_failure)
+            .stdout_flags(process::keep_in_string)
+            .arg("submodule")
+            .arg("status")
+            .cwd(root);
+    }
+
+    [[nodiscard]] process add_gitlinks(
+        const fs::path& root,
+        const std::vector<std::pair<std::string, std::string>>& links)
+    {
+        auto p = make_process()
+                     .stderr_level(context::level::trace)
+                     .arg("-c", "core.autocrlf=false")
+                     .arg("update-index")
+                     .arg("--add");
+
+        // each link is a commit hash and a path, 160000 is the mode for gitlinks
+        for (auto&& [hash, path] : links)
+            p.arg("--cacheinfo", "160000," + hash + "," + path);
+
+        p.arg(".gitmodules").cwd(root);
+
+        return p;
+    }
+
+    [[nodiscard]] process submodule_init(const fs::path& root)
     {
         return make_process()
             .stderr_level(context::level::trace)
-            .arg("-c", "core.autocrlf=false")
             .arg("submodule")
             .arg("--quiet")
-            .arg("add")
-            .arg("-b", branch)
-            .arg("--force")
-            .arg("--name", submodule)
-            .arg(url)
-            .arg(submodule)
+            .arg("init")
+            .cwd(root);
+    }
+
+    [[nodiscard]] process rev_parse_head(const fs::path& root)
+    {
+        return make_process()
+            .flags(process::allow_failure)
+            .stdout_flags(process::keep_in_string)
+            .stderr_level(context::level::trace)
+            .arg("rev-parse")
+            .arg("HEAD")
             .cwd(root);
     }
 
@@ -213,48 +450,37 @@ namespace mob::details {
             .cwd(root);
     }
 
-    [[nodiscard]] process is_repo(const fs::path& root)
-    {
-        return make_process()
-            .arg("rev-parse")
-            .arg("--is-inside-work-tree")
-            .stderr_filter([](process::filter& f) {
-                if (f.line.find("not a git repo") != std::string::npos)
-                    f.lv = context::level::trace;
-            })
-            .flags(process::allow_failure)
-            .cwd(root);
-    }
-
-    [[nodiscard]] process remote_branch_exists(const mob::url& url,
-                                               const std::string& branch)
+    [[nodiscard]] process ls_remote_heads(const mob::url& url)
     {
         return make_process()
             .flags(process::allow_failure)
+            .stdout_flags(process::keep_in_string)
             .arg("ls-remote")
-            .arg("--exit-code")
             .arg("--heads")
-            .arg(url)
-            .arg(branch);
+            .arg(url);
     }
 
-    [[nodiscard]] process has_uncommitted_changes(const fs::path& root)
+    [[nodiscard]] process is_ancestor_of_head(const fs::path& root,
+                                              const std::string& commit)
     {
         return make_process()
             .flags(process::allow_failure)
-            .stdout_flags(process::keep_in_string)
-            .arg("status")
-            .arg("-s")
-            .arg("--porcelain")
+            .stderr_level(context::level::trace)
+            .arg("merge-base")
+            .arg("--is-ancestor")
+            .arg(commit)
+            .arg("HEAD")
             .cwd(root);
     }
 
-    [[nodiscard]] process has_stashed_changes(const fs::path& root)
+    [[nodiscard]] process status(const fs::path& root)
     {
         return make_process()
             .flags(process::allow_failure)
-            .stderr_level(context::level::trace)
-            .arg("stash show")
+            .stdout_flags(process::keep_in_string)
+            .arg("status")
+            .arg("--porcelain=v2")
+            .arg("--branch")
             .cwd(root);
     }
 
@@ -449,17 +675,176 @@ namespace mob {
         run(details::checkout(root_, what));
     }
 
+    void git_wrap::fetch_dry_run()
+    {
+        run(details::fetch_dry_run(root_));
+    }
+
+    void git_wrap::maintain()
+    {
+        cx().debug(context::generic, "running maintenance on {}", root_);
+
+        run(details::commit_graph_write(root_));
+        run(details::multi_pack_index_write(root_));
+        run(details::incremental_repack(root_));
+    }
+
     std::string git_wrap::current_branch()
     {
+        const auto git_dir = details::find_git_dir(cx(), root_);
+
+        if (!git_dir.empty()) {
+            const auto head = details::read_head(cx(), git_dir);
+
+            // detached head
+            if (details::is_commit_hash(head))
+                return {};
+
+            const std::string prefix = "ref: refs/heads/";
+            if (head.starts_with(prefix))
+                return head.substr(prefix.size());
+        }
+
+        cx().trace(context::generic, "can't read HEAD from {}, running git", root_);
+
         auto p = details::current_branch(root_);
         run(p);
         return trim_copy(p.stdout_string());
     }
 
+    git_wrap::status_info git_wrap::status()
+    {
+        auto p = details::status(root_);
+        run(p);
+
+        status_info si;
+
+        // headers start with '#', everything else is a changed entry
+        for_each_line(p.stdout_string(), [&](std::string_view line) {
+            if (!line.starts_with("# ")) {
+                si.dirty = true;
+                return;
+            }
+
+            const auto sp = line.find(' ', 2);
+            if (sp == std::string_view::npos)
+                return;
+
+            const auto key   = line.substr(2, sp - 2);
+            const auto value = std::string(line.substr(sp + 1));
+
+            if (key == "branch.head") {
+                if (value != "(detached)")
+                    si.branch = value;
+            }
+            else if (key == "branch.upstream") {
+                si.upstream = value;
+            }
+            else if (key == "branch.ab") {
+                // "+ahead -behind"
+                const auto minus = value.find(" -");
+
+                auto to_int = [](std::string_view s, int& i) {
+                    const auto r = std::from_chars(s.data(), s.data() + s.size(), i);
+                    return (r.ec == std::errc() && r.ptr == s.data() + s.size());
+                };
+
+                int ahead  = 0;
+                int behind = 0;
+
+                // anything unexpected is left as unknown, which shows up as
+                // neither ahead nor behind
+                if (value.starts_with("+") && minus != std::string::npos &&
+                    to_int(std::string_view(value).substr(1, minus - 1), ahead) &&
+                    to_int(std::string_view(value).substr(minus + 2), behind)) {
+                    si.ahead  = ahead;
+                    si.behind = behind;
+                }
+                else {
+                    cx().trace(context::generic, "bad branch.ab '{}' in {}", value,
+                               root_);
+                }
+            }
+        });
+
+        return si;
+    }
+
     void git_wrap::add_submodule(const std::string& branch,
                                  const std::string& submodule, const mob::url& url)
     {
-        run(details::add_submodule(root_, branch, submodule, url));
+        add_submodules({{submodule, branch, url}});
+    }
+
+    void git_wrap::add_submodules(const std::vector<submodule>& v)
+    {
+        if (v.empty())
+            return;
+
+        std::set<std::string> names;
+        std::vector<std::pair<std::string, std::string>> links;
+        std::string sections;
+
+        for (auto&& s : v) {
+            const auto hash = git_wrap(root_ / s.name, runner_).head_commit();
+
+            if (hash.empty()) {
+                cx().warning(context::generic,
+                             "can't add submodule {}, failed to get its HEAD",
+                             s.name);
+
+                continue;
+            }
+
+            cx().trace(context::generic, "submodule {} at {}", s.name, hash);
+
+            names.insert(s.name);
+            links.push_back({hash, s.name});
+
+            // same format as `git submodule add`
+            sections += std::format("[submodule \"{}\"]\n"
+                                    "\tpath = {}\n"
+                                    "\turl = {}\n",
+                                    s.name, s.name, s.url.string());
+
+            if (!s.branch.empty())
+                sections += std::format("\tbranch = {}\n", s.branch);
+        }
+
+        if (links.empty())
+            return;
+
+        const auto gitmodules = root_ / ".gitmodules";
+        std::string content;
+
+        // keep everything except the submodules that are being added again
+        if (fs::exists(gitmodules)) {
+            content = details::remove_gitmodules_sections(
+                op::read_text_file(cx(), encodings::utf8, gitmodules), names);
+        }
+
+        content += sections;
+        op::write_text_file(cx(), encodings::utf8, gitmodules, content);
+
+        // gitlinks and .gitmodules in a single index update, then sets the
+        // submodule urls in .git/config
+        run(details::add_gitlinks(root_, links));
+        run(details::submodule_init(root_));
+    }
+
+    std::string git_wrap::head_commit()
+    {
+        const auto hash = details::read_head_commit(cx(), root_);
+        if (details::is_commit_hash(hash))
+            return hash;
+
+        cx().trace(context::generic, "can't read HEAD from {}, running git", root_);
+
+        auto p = details::rev_parse_head(root_);
+        if (run(p) != 0)
+            return {};
+
+        return trim_copy(p.stdout_string());
     }
 
     std::string git_wrap::git_file()
@@ -530,25 +915,181 @@ namespace mob {
 
     bool git_wrap::is_git_repo()
     {
-        return (run(details::is_repo(root_)) == 0);
+        // a .git directory or file with a HEAD, which is the common case
+        const auto git_dir = details::find_git_dir(cx(), root_);
+        if (!git_dir.empty() && !details::read_head(cx(), git_dir).empty())
+            return true;
+
+        // git also looks in parent directories and might be able to read a HEAD
+        // that wasn't understood above; delete_directory() relies on this to
+        // check for changes before deleting anything
+        return !git_dir().empty();
+    }
+
+    fs::path git_wrap::git_dir()
+    {
+        const auto dir = details::find_git_dir(cx(), root_);
+        if (!dir.empty())
+            return dir;
+
+        if (!fs::exists(root_))
+            return {};
+
+        cx().trace(context::generic, "no .git in {}, running git", root_);
+
+        auto p = details::absolute_git_dir(root_);
+        if (run(p) != 0)
+            return {};
+
+        return fs::path(utf8_to_utf16(trim_copy(p.stdout_string())));
     }
 
     bool git_wrap::remote_branch_exists(const mob::url& u, const std::string& name)
     {
-        return (details::remote_branch_exists(u, name).run_and_join() == 0);
+        return !remote_head(u, name).empty();
+    }
+
+    std::string git_wrap::remote_head(const mob::url& u, const std::string& branch)
+    {
+        // "refs/heads/branch" -> hash for every branch of a url, empty if the
+        // remote can't be reached
+        using heads = std::map<std::string, std::string>;
+
+        static std::map<std::string, std::shared_future<heads>> cache;
+        static std::mutex cache_mutex;
+
+        std::promise<heads> promise;
+        std::shared_future<heads> f;
+        bool first = false;
+
+        {
+            std::scoped_lock lock(cache_mutex);
+
+            auto itor = cache.find(u.string());
+            if (itor == cache.end()) {
+                f     = promise.get_future().share();
+                first = true;
+
+                cache.emplace(u.string(), f);
+            }
+            else {
+                f = itor->second;
+            }
+        }
+
+        // all the branches are listed at once, tasks often check more than one
+        // branch on the same remote, like a fallback branch, and other callers
+        // for the same url wait for this one
+        //
+        // failures are not remembered, the callers waiting on this one get the
+        // same result, but the next ones try again
+        if (first) {
+            auto forget = [&] {
+                std::scoped_lock lock(cache_mutex);
+                cache.erase(u.string());
+            };
+
+            try {
+                auto p = details::ls_remote_heads(u);
+                p.run_and_join();
+
+                heads hs;
+
+                // lines are "hash<tab>ref"
+                if (p.exit_code() == 0) {
+                    for_each_line(p.stdout_string(), [&](std::string_view line) {
+                        const auto tab = line.find('\t');
+                        if (tab == std::string_view::npos)
+                            return;
+
+                        hs.emplace(trim_copy(line.substr(tab + 1)),
+                                   std::string(line.substr(0, tab)));
+                    });
+                }
+                else {
+                    forget();
+                }
+
+                promise.set_value(std::move(hs));
+            }
+            catch (...) {
+                forget();
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+        }
+
+        const auto& hs = f.get();
+
+        auto itor = hs.find("refs/heads/" + branch);
+        if (itor == hs.end())
+            return {};
+
+        return itor->second;
+    }
+
+    bool git_wrap::is_up_to_date(const mob::url& u, const std::string& branch)
+    {
+        const auto remote = remote_head(u, branch);
+        if (remote.empty())
+            return false;
+
+        const auto head = head_commit();
+
+        if (head != remote) {
+            cx().trace(context::generic, "HEAD is {}, remote {} is {}", head,
+                       branch, remote);
+
+            // there might be local commits on top, in which case pulling would
+            // be a no-op; this fails if the remote commit is unknown locally
+            if (run(details::is_ancestor_of_head(root_, remote)) != 0)
+                return false;
+        }
+
+        // pulling also updates the submodules with --recurse-submodules
+        return submodules_up_to_date();
+    }
+
+    bool git_wrap::submodules_up_to_date()
+    {
+        // most repos don't have submodules, don't spawn git for them
+        if (!fs::exists(root_ / ".gitmodules"))
+            return true;
+
+        auto p = details::submodule_status(root_);
+        if (run(p) != 0)
+            return false;
+
+        // lines start with a space if the submodule is checked out at the commit
+        // in its gitlink, '+' if it's at another commit and 'U' for conflicts;
+        // '-' is for submodules that aren't initialized, which pulling doesn't
+        // change
+        bool up_to_date = true;
+
+        for_each_line(p.stdout_string(), [&](std::string_view line) {
+            if (line.starts_with("+") || line.starts_with("U")) {
+                cx().trace(context::generic, "submodule not up to date: {}", line);
+                up_to_date = false;
+            }
+        });
+
+        return up_to_date;
     }
 
     bool git_wrap::has_uncommitted_changes()
     {
-        auto p = details::has_uncommitted_changes(root_);
-        run(p);
-        return (p.stdout_string() != "");
+        // comparing the working tree with the index needs git
+        return status().dirty;
     }
 
     bool git_wrap::has_stashed_changes()
     {
-        auto p = details::has_stashed_changes(root_);
-        return (run(p) == 0);
+        // stashes are in refs/stash
+        const auto dir = git_dir();
+        if (dir.empty())
+            return false;
+
+        return !details::read_ref(cx(), dir, "refs/stash").empty();
     }
 
     git::git(ops o)
@@ -670,6 +1211,16 @@ namespace mob {
     {
         git_wrap g(root_, this);
 
+        // checking the remote is much faster than pulling, and skipping the pull
+        // also avoids reverting the .ts files, which would touch them and make
+        // the translations rebuild
+        if (g.is_up_to_date(url_, branch_)) {
+            cx().debug(context::generic, "{} is up to date with {} {}, not pulling",
+                       root_, url_, branch_);
+
+            return;
+        }
+
         if (revert_ts_)
             g.revert_ts();
 
@@ -707,9 +1258,47 @@ namespace mob {
         return submodule_;
     }
 
+    const fs::path& git_submodule::root() const
+    {
+        return root_;
+    }
+
+    git_submodule& git_submodule::merge(const git_submodule& g)
+    {
+        MOB_ASSERT(g.root_ == root_);
+
+        merged_.push_back({g.submodule_, g.branch_, g.url_});
+        merged_.insert(merged_.end(), g.merged_.begin(), g.merged_.end());
+
+        return *this;
+    }
+
     void git_submodule::do_run()
     {
-        git_wrap(root_, this).add_submodule(branch_, submodule_, url_);
+        std::vector<git_wrap::submodule> v;
+
+        v.push_back({submodule_, branch_, url_});
+        v.insert(v.end(), merged_.begin(), merged_.end());
+
+        git_wrap(root_, this).add_submodules(v);
+    }
+
+    git_maintenance::git_maintenance() : basic_process_runner("git maintenance") {}
+
+    git_maintenance& git_maintenance::root(const fs::path& dir)
+    {
+        root_ = dir;
+        return *this;
+    }
+
+    const fs::path& git_maintenance::root() const
+    {
+        return root_;
+    }
+
+    void git_maintenance::do_run()
+    {
+        git_wrap(root_, this).maintain();
     }
 
     static std::unique_ptr<git_submodule_adder> g_sa_instance;
@@ -744,6 +1333,31 @@ namespace mob {
         wakeup();
     }
 
+    void git_submodule_adder::queue(git_maintenance g)
+    {
+        std::scoped_lock lock(queue_mutex_);
+        maintenance_queue_.emplace_back(std::move(g));
+        wakeup();
+    }
+
+    void git_submodule_adder::finish_maintenance()
+    {
+        // the thread won't start another one while this is held
+        std::scoped_lock run_lock(maintenance_mutex_);
+
+        std::vector<git_maintenance> v;
+
+        {
+            std::scoped_lock lock(queue_mutex_);
+            v.swap(maintenance_queue_);
+        }
+
+        context cx("git_maintenance");
+
+        for (auto&& g : v)
+            g.run(cx);
+    }
+
     void git_submodule_adder::run()
     {
         thread_ = start_thread([&] {
@@ -762,8 +1376,10 @@ namespace mob {
         try {
             while (!quit_) {
                 {
+                    // the cpu_pool doesn't wake up this thread when it becomes
+                    // idle, so wake up periodically for the maintenance queue
                     std::unique_lock lk(sleeper_.m);
-                    sleeper_.cv.wait(lk, [&] {
+                    sleeper_.cv.wait_for(lk, std::chrono::seconds(1), [&] {
                         return sleeper_.ready;
                     });
                     sleeper_.ready = false;
@@ -791,8 +1407,36 @@ namespace mob {
         sleeper_.cv.notify_one();
     }
 
+    void git_submodule_adder::settle()
+    {
+        // this is called right after queue() woke up the thread, wait until no
+        // new submodule has been queued for a while
+        const auto delay = std::chrono::milliseconds(500);
+        std::size_t last = 0;
+
+        for (;;) {
+            {
+                std::scoped_lock lock(queue_mutex_);
+                if (queue_.size() == last)
+                    break;
+
+                last = queue_.size();
+            }
+
+            std::unique_lock lk(sleeper_.m);
+            sleeper_.cv.wait_for(lk, delay, [&] {
+                return quit_.load();
+            });
+
+            if (quit_)
+                break;
+        }
+    }
+
     void git_submodule_adder::process()
     {
+        settle();
+
         std::vector<git_submodule> v;
 
         {
@@ -800,17 +1444,69 @@ namespace mob {
             v.swap(queue_);
         }
 
+        if (v.empty()) {
+            process_maintenance();
+            return;
+        }
+
         cx_.trace(context::generic, "git_submodule_adder: woke up, {} to process",
                   v.size());
 
+        // merge everything with the same root, which is normally all of them
+        std::vector<git_submodule> batches;
+
         for (auto&& g : v) {
-            cx_.trace(context::generic, "git_submodule_adder: running {}",
+            cx_.trace(context::generic, "git_submodule_adder: adding {}",
                       g.submodule());
 
-            g.run(cx_);
+            auto itor = std::find_if(batches.begin(), batches.end(), [&](auto&& b) {
+                return (b.root() == g.root());
+            });
+
+            if (itor == batches.end())
+                batches.push_back(std::move(g));
+            else
+                itor->merge(g);
+        }
+
+        for (auto&& b : batches) {
+            cx_.trace(context::generic, "git_submodule_adder: running for {}",
+                      b.root());
+
+            b.run(cx_);
 
             if (quit_)
-                break;
+                return;
+        }
+
+        process_maintenance();
+    }
+
+    void git_submodule_adder::process_maintenance()
+    {
+        while (!quit_) {
+            std::scoped_lock run_lock(maintenance_mutex_);
+            std::optional<git_maintenance> g;
+
+            {
+                std::scoped_lock lock(queue_mutex_);
+
+                // submodules have priority, and the maintenance would compete
+                // with builds; this is called again when the thread wakes up
+                if (!queue_.empty() || maintenance_queue_.empty())
+                    return;
+
+                if (!cpu_pool::instance().idle())
+                    return;
+
+                g = std::move(maintenance_queue_.front());
+                maintenance_queue_.erase(maintenance_queue_.begin());
+            }
+
+            cx_.trace(context::generic, "git_submodule_adder: maintenance for {}",
+                      g->root());
+
+            g->run(cx_);
         }
     }
 
@@ -150,27 +150,97 @@ namespace mob {
         //
         void checkout(const std::string& what);
 
-        // runs `git submodule add` for the given branch submodule and url
+        // runs `git fetch --dry-run` on the default remote, only used to time
+        // fetches in `mob git maintain`
+        //
+        void fetch_dry_run();
+
+        // optimizes the repo so status and fetch are faster, used by
+        // `mob git maintain` and the git_maintenance tool:
+        //  1) writes the commit-graph file,
+        //  2) writes the multi-pack-index,
+        //  3) packs loose objects and runs an incremental repack, which only
+        //     repacks small packs instead of everything like `git gc`
+        //
+        void maintain();
+
+        // a submodule given to add_submodules()
+        //
+        struct submodule {
+            // submodule name, also the name of its directory in the root
+            std::string name;
+
+            // branch, written to .gitmodules
+            std::string branch;
+
+            // remote url
+            mob::url url;
+        };
+
+        // registers the given submodule, see add_submodules()
         //
         void add_submodule(const std::string& branch, const std::string& submodule,
                            const mob::url& url);
 
-        // returns the output of `git branch --show-current`, which is the name of
-        // the active branch
+        // registers all the given submodules at once; each submodule must already
+        // be a cloned repo in root/name
+        //
+        // running `git submodule add` for each one rewrites .gitmodules and the
+        // index every time, which is slow for 35 projects, so this writes all the
+        // entries to .gitmodules directly, adds all the gitlinks with a single
+        // `git update-index` and runs `git submodule init` once
+        //
+        void add_submodules(const std::vector<submodule>& v);
+
+        // returns the hash of the commit HEAD points to; this is read directly
+        // from the .git directory when possible, falls back to
+        // `git rev-parse HEAD` otherwise; returns an empty string on failure
+        //
+        std::string head_commit();
+
+        // state of the working tree and branch, returned by status()
+        //
+        struct status_info {
+            // current branch, empty on detached head
+            std::string branch;
+
+            // upstream branch, such as "origin/master", empty if none
+            std::string upstream;
+
+            // number of commits ahead and behind upstream
+            int ahead  = 0;
+            int behind = 0;
+
+            // whether there are any changes in the working tree or the index,
+            // including untracked files
+            bool dirty = false;
+        };
+
+        // runs `git status --porcelain=v2 --branch` and parses the output; this
+        // doesn't fetch, so ahead/behind are relative to the last fetch
+        //
+        status_info status();
+
+        // returns the name of the active branch, or an empty string for a
+        // detached head; HEAD is read directly from the .git directory when
+        // possible, falls back to `git branch --show-current`
         //
         std::string current_branch();
 
-        // whether the root directory given in the constructor is a valid git repo
+        // whether the root directory given in the constructor is in a git repo;
+        // checks for a .git directory or file with a HEAD first, falls back to
+        // `git rev-parse --absolute-git-dir`, which also looks in parent
+        // directories
         //
         bool is_git_repo();
 
-        // whether the repo has uncommitted changes (basically checks `git status`);
-        // see delete_directory() below
+        // whether the repo has uncommitted changes, including untracked files;
+        // this is status().dirty; see delete_directory() below
         //
         bool has_uncommitted_changes();
 
-        // whether the repo has stashed changes (checks `git stash show`); see
-        // delete_directory() below
+        // whether the repo has stashed changes, checks if refs/stash exists
+        // in git_dir(); see delete_directory() below
         //
         bool has_stashed_changes();
 
@@ -183,8 +253,8 @@ namespace mob {
         //
         static void delete_directory(const context& cx, const fs::path& dir);
 
-        // runs `git ls-remote` to check if the repo at the url has the given branch
-        // name
+        // checks if the repo at the url has the given branch name, see
+        // remote_head()
         //
         // used mostly by `mob release official` when given a branch name to make
         // sure the branch exists in all repos before starting the build so it
@@ -192,6 +262,22 @@ namespace mob {
         //
         static bool remote_branch_exists(const mob::url& u, const std::string& name);
 
+        // returns the commit hash of the given branch on the remote, or an empty
+        // string if the branch doesn't exist or the remote can't be reached
+        //
+        // this runs `git ls-remote --heads` once per url for all its branches,
+        // the result is cached for the lifetime of the process; it's used both to
+        // check if a branch exists and to avoid pulling when nothing has changed
+        //
+        static std::string remote_head(const mob::url& u, const std::string& branch);
+
+        // whether pulling the given branch from the url would not change
+        // anything: the remote commit is either HEAD or one of its ancestors,
+        // and the submodules are checked out at their gitlinks; returns false if
+        // the remote can't be checked
+        //
+        bool is_up_to_date(const mob::url& u, const std::string& branch);
+
     private:
         // git root directory, from constructor
         fs::path root_;
@@ -211,6 +297,17 @@ namespace mob {
         // log context, either gcx() or the one from runner_ if it's not null
         //
         const context& cx();
+
+        // the .git directory of the repo, or the directory a .git file points
+        // to; asks git if it's not in the root, empty if it's not a repo
+        //
+        fs::path git_dir();
+
+        // whether every initialized submodule is checked out at the commit in
+        // its gitlink, as `git pull --recurse-submodules` would leave them;
+        // only spawns git if there's a .gitmodules
+        //
+        bool submodules_up_to_date();
     };
 
     // tool to handle git operations, used by tasks
@@ -317,6 +414,15 @@ namespace mob {
         git_submodule& submodule(const std::string& name);
         const std::string& submodule() const;
 
+        // root directory given in root()
+        //
+        const fs::path& root() const;
+
+        // adds the submodules of the given tool to this one so they're all
+        // registered in the same run(); both tools must have the same root
+        //
+        git_submodule& merge(const git_submodule& g);
+
     protected:
         void do_run() override;
 
@@ -325,11 +431,43 @@ namespace mob {
         fs::path root_;
         std::string branch_;
         std::string submodule_;
+
+        // submodules added by merge()
+        std::vector<git_wrap::submodule> merged_;
+    };
+
+    // tool that runs git_wrap::maintain() on a repo, queued in the
+    // git_submodule_adder by tasks that have the git_maintenance option set once
+    // their repo is built
+    //
+    class git_maintenance : public basic_process_runner {
+    public:
+        git_maintenance();
+
+        // root directory of the repo
+        //
+        git_maintenance& root(const fs::path& dir);
+        const fs::path& root() const;
+
+    protected:
+        void do_run() override;
+
+    private:
+        fs::path root_;
     };
 
     // queues submodule operations with queue(), runs them in a thread because they
     // take a long time but can happen while stuff is building
     //
+    // everything that was queued when the thread wakes up is merged into a single
+    // git_submodule per root, so the submodules are registered in one go instead
+    // of running git for each of them
+    //
+    // git_maintenance tools can also be queued, they're low priority: they're run
+    // one at a time in the same thread when no submodules are left to add and
+    // nothing is using the cpu_pool, and finish_maintenance() runs whatever is
+    // left once the build is done
+    //
     class git_submodule_adder {
     public:
         // calls stop() and joins
@@ -345,6 +483,15 @@ namespace mob {
         //
         void queue(git_submodule g);
 
+        // adds a repo to the maintenance queue
+        //
+        void queue(git_maintenance g);
+
+        // waits for the maintenance that's running in the thread, if any, and
+        // runs everything left in the maintenance queue in the calling thread
+        //
+        void finish_maintenance();
+
         // stops the thread
         //
         void stop();
@@ -364,10 +511,14 @@ namespace mob {
         // thread
         std::thread thread_;
 
-        // queue
+        // queues, both protected by queue_mutex_
         std::vector<git_submodule> queue_;
+        std::vector<git_maintenance> maintenance_queue_;
         mutable std::mutex queue_mutex_;
 
+        // held while a git_maintenance runs
+        std::mutex maintenance_mutex_;
+
         // true in stop(), stops the thread
         std::atomic<bool> quit_;
 
@@ -380,7 +531,8 @@ namespace mob {
         //
         void run();
 
-        // thread function, sleeps until queue() is called
+        // thread function, sleeps until queue() is called or for a second, which
+        // is when the maintenance queue checks if the cpu_pool is idle
         //
         void thread_fun();
 
@@ -388,9 +540,19 @@ namespace mob {
         //
         void wakeup();
 
+        // waits until nothing new has been queued for a little while, tasks are
+        // typically started at the same time so their submodules can be batched
+        //
+        void settle();
+
         // processes the queue
         //
         void process();
+
+        // runs the maintenance queue, one repo at a time, as long as there are
+        // no submodules to add and the cpu_pool is idle
+        //
+        void process_maintenance();
     };
 
 }  // namespace mob
@@ -105,7 +105,25 @@ namespace mob {
 
     void msbuild::do_build()
     {
-        run_for_targets(targets_);
+        // projects that fail because of locked files are built again, see
+        // build_loop()
+        const bool built = build_loop(cx(), [&](auto&& failed) {
+            // targets for projects in a solution have dots replaced by
+            // underscores
+            auto r = run_for_targets(
+                failed.empty() ? targets_ : map(failed, [](auto&& s) {
+                    return replace_all(s, ".", "_");
+                }));
+
+            // for the report at the end of the build
+            for (auto&& t : r.timings)
+                add_build_timing({path_to_utf8(sln_.stem()), t.target, t.time});
+
+            return r;
+        });
+
+        if (!built && !is_set(flags_, allow_failure))
+            cx().bail_out(context::generic, "msbuild returned {}", exit_code());
     }
 
     std::string msbuild::platform_property() const
@@ -126,28 +144,24 @@ namespace mob {
         }
     }
 
-    void msbuild::run_for_targets(const std::vector<std::string>& targets)
+    build_attempt
+    msbuild::run_for_targets(const std::vector<std::string>& targets)
     {
         // 14.2 to v142
         const auto toolset = "v" + replace_all(vs::toolset(), ".", "");
 
+        build_attempt r;
         process p;
 
+        // failures are handled by the caller, either ignored or retried
+        p.flags(process::allow_failure);
+
         if (is_set(flags_, allow_failure)) {
-            // make sure errors are not displayed and mob doesn't bail out
-            p.stderr_level(context::level::trace).flags(process::allow_failure);
+            // make sure errors are not displayed
+            p.stderr_level(context::level::trace);
         }
         else {
-            p.stdout_filter([&](auto& f) {
-                // ": error C2065"
-                // ": error MSB1009"
-                static std::regex re(": error [A-Z]");
-
-                // ghetto attempt at showing errors on the console, since stdout
-                // has all the compiler output
-                if (std::regex_search(f.line.begin(), f.line.end(), re))
-                    f.lv = context::level::error;
-            });
+            filter_build_output(p, r);
         }
 
         // msbuild will use the console's encoding, so by invoking `chcp 65001`
@@ -158,11 +172,18 @@ namespace mob {
             .stderr_encoding(encodings::utf8)
             .arg("-nologo");
 
+        // share of the global cpu pool, held until the build is finished; single
+        // job builds still take one so they're counted
+        const auto tokens = cpu_pool::instance().acquire(
+            is_set(flags_, single_job) ? 1 : 0);
+
         if (!is_set(flags_, single_job)) {
-            // multi-process
-            p.arg("-maxCpuCount")
+            // multi-process, the number of processes across all projects is
+            // capped by CL_MPCount because of EnforceProcessCountAcrossBuilds
+            p.arg("-maxCpuCount:" + std::to_string(tokens.count()))
                 .arg("-property:UseMultiToolTask=true")
-                .arg("-property:EnforceProcessCountAcrossBuilds=true");
+                .arg("-property:EnforceProcessCountAcrossBuilds=true")
+                .arg("-property:CL_MPCount=" + std::to_string(tokens.count()));
         }
 
         p.arg("-property:Configuration=", configuration_name(config_), process::quote)
@@ -170,7 +191,8 @@ namespace mob {
             .arg("-property:WindowsTargetPlatformVersion=" + vs::sdk())
             .arg("-property:Platform=", platform_property(), process::quote)
             .arg("-verbosity:minimal", process::log_quiet)
-            .arg("-consoleLoggerParameters:ErrorsOnly", process::log_quiet);
+            .arg("-consoleLoggerParameters:ErrorsOnly;PerformanceSummary",
+                 process::log_quiet);
 
         // some projects have code analysis turned on and can fail on preview
         // versions, make sure it's never run
@@ -186,7 +208,8 @@ namespace mob {
 
         p.arg(sln_).cwd(sln_.parent_path()).env(env_ ? *env_ : env::vs(arch_));
 
-        execute_and_join(p);
+        r.success = (execute_and_join(p) == 0);
+        return r;
     }
 
     void msbuild::do_clean()
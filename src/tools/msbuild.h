@@ -93,9 +93,10 @@ namespace mob {
         //
         void do_build();
 
-        // called by both do_clean() and do_build
+        // called by both do_clean() and do_build, errors are only collected
+        // when allow_failure is not set
         //
-        void run_for_targets(const std::vector<std::string>& targets);
+        build_attempt run_for_targets(const std::vector<std::string>& targets);
 
         std::string platform_property() const;
     };
@@ -4,6 +4,12 @@
 
 namespace mob {
 
+    namespace {
+        // timings for build_timings(), keyed on project and target
+        std::map<std::pair<std::string, std::string>, build_timing> g_timings;
+        std::mutex g_timings_mutex;
+    }  // namespace
+
     tool::tool(std::string name)
         : cx_(nullptr), name_(std::move(name)), interrupted_(false)
     {
@@ -83,6 +89,12 @@ namespace mob {
         return conf().path().get("qt_bin");
     }
 
+    env qt::with_bin_path(env e)
+    {
+        e.append_path(bin_path());
+        return e;
+    }
+
     std::string qt::version()
     {
         return conf().version().get("qt");
@@ -361,12 +373,16 @@ namespace mob {
         // that's the output file
         const auto qm = qm_file();
 
-        auto p = process().binary(binary()).arg("-silent").stderr_filter([](auto&& f) {
-            if (f.line.find("dropping duplicate") != -1)
-                f.lv = context::level::debug;
-            else if (f.line.find("try -verbose") != -1)
-                f.lv = context::level::debug;
-        });
+        auto p = process()
+                     .binary(binary())
+                     .env(qt::with_bin_path(this_env::get()))
+                     .arg("-silent")
+                     .stderr_filter([](auto&& f) {
+                         if (f.line.find("dropping duplicate") != -1)
+                             f.lv = context::level::debug;
+                         else if (f.line.find("try -verbose") != -1)
+                             f.lv = context::level::debug;
+                     });
 
         // input .ts files
         for (auto&& s : sources_)
@@ -399,30 +415,181 @@ namespace mob {
         execute_and_join(process().binary(binary()).arg(iss_));
     }
 
-    void build_loop(const context& cx, std::function<bool(bool)> f)
+    bool is_transient_build_error(std::string_view line)
     {
-        // building sometimes fails with files being locked
-        const int max_tries = 3;
+        // C1041: cannot open program database, another cl.exe is writing to it
+        // LNK1104: cannot open file, typically a dll still loaded or scanned
+        // LNK1201: error writing to program database
+        // MSB3021, MSB3026, MSB3027: copying a file that's in use
+        static const std::regex re(
+            "C1041|LNK1104|LNK1201|MSB3021|MSB3026|MSB3027|"
+            "being used by another process",
+            std::regex::icase);
 
-        for (int tries = 0; tries < max_tries; ++tries) {
-            // try a multiprocess build
-            if (f(true)) {
-                // building succeeded, done
-                return;
+        return std::regex_search(line.begin(), line.end(), re);
+    }
+
+    build_errors classify_build_errors(const std::vector<std::string>& lines)
+    {
+        // "x.cpp(12): fatal error C1041: ... [C:\path\project.vcxproj]"
+        static const std::regex project_re(R"(\[([^\]]+)\.vcxproj\]\s*$)");
+
+        build_errors e;
+        bool unattributed = false;
+
+        for (auto&& line : lines) {
+            if (!is_transient_build_error(line)) {
+                e.genuine = true;
+                continue;
+            }
+
+            e.transient = true;
+
+            std::smatch m;
+            if (!std::regex_search(line, m, project_re)) {
+                unattributed = true;
+                continue;
             }
 
-            cx.debug(context::generic,
-                     "multiprocess build sometimes fails because of race "
-                     "conditions; trying again");
+            const auto target = path_to_utf8(fs::path(m[1].str()).filename());
+
+            if (std::find(e.targets.begin(), e.targets.end(), target) ==
+                e.targets.end())
+                e.targets.push_back(target);
+        }
+
+        // a locked file that doesn't belong to a known project, such as with
+        // ninja, requires building everything again
+        if (unattributed)
+            e.targets.clear();
+
+        return e;
+    }
+
+    void add_build_timing(build_timing t)
+    {
+        std::scoped_lock lock(g_timings_mutex);
+
+        auto& total = g_timings[{t.project, t.target}];
+        total.project = std::move(t.project);
+        total.target  = std::move(t.target);
+        total.time += t.time;
+    }
+
+    std::vector<build_timing> build_timings()
+    {
+        std::vector<build_timing> v;
+
+        {
+            std::scoped_lock lock(g_timings_mutex);
+            for (auto&& [_, t] : g_timings)
+                v.push_back(t);
         }
 
-        cx.debug(context::generic,
-                 "multiprocess build has failed more than {} times, "
-                 "restarting one last time single process; that one should work",
-                 max_tries);
+        std::sort(v.begin(), v.end(), [](auto&& a, auto&& b) {
+            return (a.time > b.time);
+        });
+
+        return v;
+    }
 
-        // do one last single process build
-        f(false);
+    void filter_build_output(process& p, build_attempt& r)
+    {
+        p.stdout_filter([&r](auto& f) {
+            // ": error C2065"
+            // ": error MSB1009"
+            // ": fatal error C1041"
+            static std::regex error_re(": (fatal )?error [A-Z]");
+
+            // "     1234 ms  C:\path\project.vcxproj     2 calls", in the
+            // project performance summary at the end
+            static std::regex timing_re(
+                R"(^\s*(\d+) ms\s+(.+\.vcxproj)\s+\d+ calls?\s*$)");
+
+            std::match_results<std::string_view::const_iterator> m;
+
+            if (std::regex_search(f.line.begin(), f.line.end(), m, timing_re)) {
+                const auto target = path_to_utf8(fs::path(m[2].str()).stem());
+
+                // utility projects from cmake include the time spent waiting on
+                // the other projects
+                if (target != "ALL_BUILD" && target != "INSTALL" &&
+                    target != "ZERO_CHECK") {
+                    const std::chrono::milliseconds ms(std::stoll(m[1].str()));
+                    r.timings.push_back({"", target, ms});
+                }
+
+                return;
+            }
+
+            // ghetto attempt at showing errors on the console, since stdout
+            // has all the compiler output
+            if (!std::regex_search(f.line.begin(), f.line.end(), error_re))
+                return;
+
+            if (is_transient_build_error(f.line))
+                f.lv = context::level::warning;
+            else
+                f.lv = context::level::error;
+
+            r.errors.emplace_back(f.line);
+        });
+    }
+
+    bool build_loop(const context& cx,
+                    std::function<build_attempt(const std::vector<std::string>&)> f)
+    {
+        // locked files are normally released quickly, but a pdb or a dll can
+        // stay locked for a while, don't loop forever
+        const int max_retries = 3;
+
+        std::vector<std::string> targets;
+        int retries = 0;
+
+        for (;;) {
+            const auto r = f(targets);
+
+            if (r.success) {
+                if (targets.empty()) {
+                    // full build succeeded, done
+                    return true;
+                }
+
+                // the projects that failed are built, finish the full build
+                cx.debug(context::generic, "retried projects built, finishing");
+                targets.clear();
+                continue;
+            }
+
+            const auto e = classify_build_errors(r.errors);
+
+            if (e.genuine || !e.transient) {
+                cx.debug(context::generic, "build failed with errors, not retrying");
+                return false;
+            }
+
+            if (++retries > max_retries) {
+                cx.debug(context::generic,
+                         "build has failed because of locked files {} times, "
+                         "giving up",
+                         max_retries);
+
+                return false;
+            }
+
+            targets = e.targets;
+
+            if (targets.empty()) {
+                cx.debug(context::generic,
+                         "build failed because of locked files, trying again");
+            }
+            else {
+                cx.debug(context::generic,
+                         "build failed because of locked files, trying again "
+                         "for {}",
+                         join(targets, ", "));
+            }
+        }
     }
 
 }  // namespace mob
@@ -2,12 +2,14 @@
 
 #include "../core/conf.h"
 #include "../core/context.h"
+#include "../core/env.h"
 #include "../core/op.h"
 #include "../net.h"
 
 namespace mob {
 
     class process;
+    class env;
 
     // all the various tools used by mob itself or the tasks, most of them inherit
     // from basic_process_runner, which is a small wrapper around a `process`,
@@ -104,6 +106,12 @@ namespace mob {
         //
         static fs::path bin_path();
 
+        // returns `e` with bin_path() appended to PATH; qt is not in mob's PATH
+        // because finding it is slow, only the processes that need its tools or
+        // dlls get it, such as lrelease or the cmake builds that run windeployqt
+        //
+        static env with_bin_path(env e);
+
         // qt version from the ini
         //
         static std::string version();
@@ -593,21 +601,93 @@ namespace mob {
         fs::path iss_;
     };
 
-    // some tasks use a multiprocess version of their build tool to make things
-    // faster, but the build process might fail because the projects are not really
-    // set up correctly for multiprocess (locked files, etc.)
+    // time spent building a target, see build_timings()
+    //
+    struct build_timing {
+        // project that was built, such as "uibase"
+        std::string project;
+
+        // target within the project, such as a .vcxproj name
+        std::string target;
+
+        // for msbuild, the time msbuild spent in the project; for ninja, the
+        // sum of all the build steps, which can be longer than the wall time
+        std::chrono::milliseconds time{0};
+    };
+
+    // remembers the time spent on a target, thread-safe
     //
-    // that's the case for nmm, openssl and couple of others
+    void add_build_timing(build_timing t);
+
+    // all the targets given to add_build_timing() so far, with the times added
+    // together for the same project and target, longest first
+    //
+    std::vector<build_timing> build_timings();
+
+    // result of one build in build_loop()
+    //
+    struct build_attempt {
+        // whether the build succeeded
+        bool success = false;
+
+        // error lines from the output, see filter_build_output()
+        std::vector<std::string> errors;
+
+        // time spent in each project, from msbuild's project performance
+        // summary, see filter_build_output(); `project` is empty
+        std::vector<build_timing> timings;
+    };
+
+    // errors from a build, see classify_build_errors()
+    //
+    struct build_errors {
+        // at least one error was caused by a file being locked by another
+        // process, such as C1041 or LNK1104; building again usually works
+        bool transient = false;
+
+        // at least one error was a real error, such as a compilation error;
+        // building again will fail the same way
+        bool genuine = false;
+
+        // projects that failed because of locked files, from the "[x.vcxproj]"
+        // suffix that msbuild adds to errors; empty if a locked file couldn't be
+        // attributed to a project, which means everything must be built again
+        std::vector<std::string> targets;
+    };
+
+    // whether the given error line is about a locked file
+    //
+    bool is_transient_build_error(std::string_view line);
+
+    // classifies the error lines from a build
+    //
+    build_errors classify_build_errors(const std::vector<std::string>& lines);
+
+    // adds a stdout filter to the given process that shows the errors from
+    // msbuild or the compiler on the console and adds them to `r.errors`;
+    // errors about locked files are shown as warnings because they'll be
+    // retried
+    //
+    // if msbuild is given `-consoleLoggerParameters:PerformanceSummary`, the
+    // time spent in each project is also added to `r.timings`
+    //
+    void filter_build_output(process& p, build_attempt& r);
+
+    // builds in parallel sometimes fail because of locked files, such as a pdb
+    // used by two compilers at the same time or an output file opened by an
+    // antivirus
     //
-    // so `f` will first be called in a loop a couple of times with its parameter as
-    // `true`; it should run the build multiprocess and return whether the build
-    // succeeded, which will end the loop and return immediately
+    // `f` is called with an empty list of targets first, which should build
+    // everything; if the build failed only because of locked files, `f` is
+    // called again with the projects that failed, and then once more with an
+    // empty list to finish the build, which is a no-op for everything that was
+    // already built
     //
-    // if `f` returned false every time in the loop, it will be called one last time
-    // with its parameter as `false`, which should build one final time with any
-    // multiprocess flags
+    // builds with real errors are never retried; returns whether the build
+    // eventually succeeded
     //
-    void build_loop(const context& cx, std::function<bool(bool)> f);
+    bool build_loop(const context& cx,
+                    std::function<build_attempt(const std::vector<std::string>&)> f);
 
 }  // namespace mob
 
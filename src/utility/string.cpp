@@ -152,6 +152,16 @@ namespace mob {
         return s;
     }
 
+    std::uint64_t fnv1a(std::string_view s, std::uint64_t h)
+    {
+        for (const unsigned char c : s) {
+            h ^= c;
+            h *= 0x100000001b3;
+        }
+
+        return h;
+    }
+
     std::string table(const std::vector<std::pair<std::string, std::string>>& v,
                       std::size_t indent, std::size_t spacing)
     {
@@ -67,6 +67,11 @@ namespace mob {
     std::string trim_copy(std::string_view s, std::string_view what = " \t\r\n");
     std::wstring trim_copy(std::wstring_view s, std::wstring_view what = L" \t\r\n");
 
+    // 64-bit fnv-1a of `s`, starting from `h`; stable across runs and builds,
+    // unlike std::hash, so it's used for the keys of the caches written to disk
+    //
+    std::uint64_t fnv1a(std::string_view s, std::uint64_t h = 0xcbf29ce484222325);
+
     // formats a vector of pairs into two columns, putting `indent` spaces at the
     // start of each line and `spacing` spaces between the columns
     //
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "threading.h"
+#include "../core/context.h"
 #include "../utility.h"
 
 namespace mob {
@@ -190,6 +191,216 @@ namespace mob {
         return std::max<std::size_t>(1, count.value_or(def));
     }
 
+    cpu_pool::lease::lease() : pool_(nullptr), count_(0) {}
+
+    cpu_pool::lease::lease(cpu_pool& pool, std::size_t count)
+        : pool_(&pool), count_(count)
+    {
+    }
+
+    cpu_pool::lease::lease(lease&& other) : pool_(other.pool_), count_(other.count_)
+    {
+        other.pool_  = nullptr;
+        other.count_ = 0;
+    }
+
+    cpu_pool::lease& cpu_pool::lease::operator=(lease&& other)
+    {
+        if (this != &other) {
+            release();
+
+            pool_        = other.pool_;
+            count_       = other.count_;
+            other.pool_  = nullptr;
+            other.count_ = 0;
+        }
+
+        return *this;
+    }
+
+    cpu_pool::lease::~lease()
+    {
+        release();
+    }
+
+    std::size_t cpu_pool::lease::count() const
+    {
+        return count_;
+    }
+
+    void cpu_pool::lease::release()
+    {
+        if (pool_)
+            pool_->release(count_);
+
+        pool_  = nullptr;
+        count_ = 0;
+    }
+
+    // total and available physical memory, both 0 on failure
+    //
+    static std::pair<std::uint64_t, std::uint64_t> physical_memory()
+    {
+        MEMORYSTATUSEX ms = {};
+        ms.dwLength       = sizeof(ms);
+
+        if (!GlobalMemoryStatusEx(&ms))
+            return {0, 0};
+
+        return {ms.ullTotalPhys, ms.ullAvailPhys};
+    }
+
+    cpu_pool::cpu_pool()
+        : size_(make_thread_count({})), free_(size_), users_(0),
+          memory_threshold_(0), memory_baseline_(0)
+    {
+    }
+
+    cpu_pool& cpu_pool::instance()
+    {
+        static cpu_pool p;
+        return p;
+    }
+
+    void cpu_pool::set_size(std::size_t n)
+    {
+        {
+            std::scoped_lock lock(mutex_);
+
+            const auto new_size = (n == 0 ? make_thread_count({}) : n);
+            const auto held     = size_ - free_;
+
+            size_ = new_size;
+            free_ = (new_size > held ? new_size - held : 0);
+        }
+
+        cv_.notify_all();
+    }
+
+    std::size_t cpu_pool::size() const
+    {
+        std::scoped_lock lock(mutex_);
+        return size_;
+    }
+
+    void cpu_pool::set_memory_threshold(std::uint64_t bytes)
+    {
+        {
+            std::scoped_lock lock(mutex_);
+            memory_threshold_ = bytes;
+        }
+
+        cv_.notify_all();
+    }
+
+    cpu_pool::lease cpu_pool::acquire(std::size_t max)
+    {
+        std::unique_lock lock(mutex_);
+
+        ++users_;
+
+        std::size_t memory_max = 0;
+        bool logged            = false;
+
+        // a token must be free and there must be enough memory at the same time,
+        // both are checked again after any wait because other threads can take
+        // tokens while the lock is released
+        for (;;) {
+            cv_.wait(lock, [&] {
+                return (free_ > 0);
+            });
+
+            if (const auto m = memory_share(logged)) {
+                memory_max = *m;
+                break;
+            }
+
+            // woken up when a lease is released, but memory can also be freed
+            // by builds that are still running, so check periodically
+            cv_.wait_for(lock, std::chrono::seconds(1));
+        }
+
+        // everybody using the pool gets the same share, but don't wait for
+        // tokens that are held by others
+        std::size_t n = std::max<std::size_t>(1, size_ / users_);
+        n             = std::min(n, free_);
+
+        if (max > 0)
+            n = std::min(n, max);
+
+        if (memory_max > 0)
+            n = std::min(n, memory_max);
+
+        MOB_ASSERT(n >= 1);
+        free_ -= n;
+
+        return lease(*this, n);
+    }
+
+    bool cpu_pool::idle() const
+    {
+        std::scoped_lock lock(mutex_);
+        return (users_ == 0);
+    }
+
+    std::optional<std::size_t> cpu_pool::memory_share(bool& logged)
+    {
+        if (memory_threshold_ == 0)
+            return 0;
+
+        const auto [total, available] = physical_memory();
+        if (total == 0)
+            return 0;
+
+        const auto used = total - available;
+        const auto held = size_ - free_;
+
+        if (held == 0) {
+            // nothing is running, this is what mob and everything else on the
+            // system is using; never wait, something has to run
+            memory_baseline_ = used;
+            return 0;
+        }
+
+        if (available >= memory_threshold_) {
+            // estimate the memory used by a token from what the running builds
+            // are using, and give as many as fit above the threshold
+            const auto builds =
+                (used > memory_baseline_ ? used - memory_baseline_ : 0);
+
+            const auto per_token = builds / held;
+
+            if (per_token == 0)
+                return 0;
+
+            const auto fit = (available - memory_threshold_) / per_token;
+            return static_cast<std::size_t>(std::max<std::uint64_t>(1, fit));
+        }
+
+        if (!logged) {
+            gcx().debug(context::generic,
+                        "only {} MB of memory available, waiting for builds to "
+                        "finish",
+                        available / (1024 * 1024));
+
+            logged = true;
+        }
+
+        return {};
+    }
+
+    void cpu_pool::release(std::size_t n)
+    {
+        {
+            std::scoped_lock lock(mutex_);
+
+            free_ = std::min(size_, free_ + n);
+            --users_;
+        }
+
+        cv_.notify_all();
+    }
+
     thread_pool::thread_pool(std::optional<std::size_t> count)
         : count_(make_thread_count(count))
     {
@@ -57,4 +57,116 @@ namespace mob {
         bool try_add(fun thread_fun);
     };
 
+    // global pool of cpu tokens, shared by everything that runs jobs in parallel,
+    // like cmake, msbuild or task::parallel()
+    //
+    // tasks in a parallel_tasks all run at the same time and each build tool can
+    // spawn a process per core, which oversubscribes the machine; instead, tools
+    // acquire() a share of the pool before starting a build and use the number of
+    // tokens they got for their own parallelism (--parallel, -maxCpuCount, etc.)
+    //
+    // the share is the size of the pool divided by the number of leases currently
+    // held or waiting when the lease is acquired; a lease keeps its tokens until
+    // it's released, builds that are already running don't get more when others
+    // finish because their process can't change its parallelism anyway
+    //
+    // if a memory threshold is set, acquire() also samples the available physical
+    // memory: when it's below the threshold, new builds wait until running ones
+    // finish or memory is freed, and when it's getting close, new builds get
+    // fewer tokens based on how much memory each token held by the running builds
+    // uses
+    //
+    class cpu_pool {
+    public:
+        // holds tokens from the pool, gives them back when destroyed
+        //
+        class lease {
+        public:
+            lease();
+            lease(cpu_pool& pool, std::size_t count);
+            lease(lease&& other);
+            lease& operator=(lease&& other);
+            ~lease();
+
+            // non-copyable
+            lease(const lease&)            = delete;
+            lease& operator=(const lease&) = delete;
+
+            // number of tokens held, always at least 1 unless the lease was
+            // released
+            //
+            std::size_t count() const;
+
+            // gives the tokens back to the pool
+            //
+            void release();
+
+        private:
+            cpu_pool* pool_;
+            std::size_t count_;
+        };
+
+        // global pool
+        //
+        static cpu_pool& instance();
+
+        // sets the number of tokens, 0 uses the number of cores; this is the
+        // `jobs` option in [global]
+        //
+        void set_size(std::size_t n);
+
+        // number of tokens
+        //
+        std::size_t size() const;
+
+        // minimum amount of free physical memory in bytes before new leases are
+        // delayed, 0 disables it; this is the `min_free_memory` option in
+        // [global]
+        //
+        void set_memory_threshold(std::uint64_t bytes);
+
+        // blocks until at least one token is available, then takes a fair share
+        // of the free tokens, never more than `max` if it's not 0
+        //
+        lease acquire(std::size_t max = 0);
+
+        // true if no lease is held or waited for, used by background work that
+        // shouldn't compete with builds
+        //
+        bool idle() const;
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+
+        // total number of tokens
+        std::size_t size_;
+
+        // tokens not held by a lease
+        std::size_t free_;
+
+        // number of leases held or waiting in acquire()
+        std::size_t users_;
+
+        // see set_memory_threshold()
+        std::uint64_t memory_threshold_;
+
+        // memory in use the last time no tokens were held, used to estimate
+        // how much memory the running builds are using
+        std::uint64_t memory_baseline_;
+
+        cpu_pool();
+
+        // returns the maximum number of tokens that should be given considering
+        // the memory used by the running builds, 0 for no limit, or nothing if
+        // there isn't enough memory and acquire() should wait; mutex_ must be
+        // held, `logged` is set once the wait has been logged
+        //
+        std::optional<std::size_t> memory_share(bool& logged);
+
+        // called by lease::release()
+        //
+        void release(std::size_t n);
+    };
+
 }  // namespace mob